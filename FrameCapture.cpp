@@ -0,0 +1,186 @@
+#include "FrameCapture.h"
+#include "PngWriter.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <utility>
+
+FrameCapture::~FrameCapture() {
+    if (encodeQueue) {
+        encodeQueue->Close();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+bool FrameCapture::Initialize(const wgpu::Device& device, uint32_t width, uint32_t height,
+                              const std::string& outputDir, CaptureFormat format, size_t workerCount) {
+    this->device = device;
+    this->width = width;
+    this->height = height;
+    this->outputDir = outputDir;
+    this->format = format;
+
+    std::error_code error;
+    std::filesystem::create_directories(outputDir, error);
+    if (error) {
+        std::cerr << "Failed to create capture directory: " << outputDir << std::endl;
+        return false;
+    }
+
+    // Buffer copies need rows aligned to 256 bytes
+    paddedBytesPerRow = (width * 4 + 255) / 256 * 256;
+
+    slots = std::make_unique<Slot[]>(kRingSize);
+    for (size_t i = 0; i < kRingSize; ++i) {
+        wgpu::BufferDescriptor bufferDesc = {};
+        bufferDesc.size = static_cast<uint64_t>(paddedBytesPerRow) * height;
+        bufferDesc.usage = wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst;
+        slots[i].buffer = device.CreateBuffer(&bufferDesc);
+    }
+
+    encodeQueue = std::make_unique<BoundedQueue<Frame>>(kEncodeQueueDepth);
+    for (size_t i = 0; i < std::max<size_t>(workerCount, 1); ++i) {
+        workers.emplace_back(&FrameCapture::WorkerLoop, this);
+    }
+    return true;
+}
+
+void FrameCapture::EncodeCopy(const wgpu::CommandEncoder& encoder, const wgpu::Texture& texture) {
+    // Slots are used in order, so the next one is the oldest; wait for it
+    // only when the whole ring is in flight.
+    Slot& slot = slots[nextSlot];
+    while (slot.state != SlotState::Free) {
+        RequestMaps(0);
+        Poll();
+        std::this_thread::yield();
+    }
+
+    wgpu::TexelCopyTextureInfo source = {};
+    source.texture = texture;
+    wgpu::TexelCopyBufferInfo destination = {};
+    destination.buffer = slot.buffer;
+    destination.layout.bytesPerRow = paddedBytesPerRow;
+    destination.layout.rowsPerImage = height;
+    wgpu::Extent3D copySize = {width, height, 1};
+    encoder.CopyTextureToBuffer(&source, &destination, &copySize);
+
+    slot.state = SlotState::Copying;
+    slot.frameIndex = framesCaptured++;
+    encodedSlot = static_cast<int>(nextSlot);
+    nextSlot = (nextSlot + 1) % kRingSize;
+}
+
+void FrameCapture::OnSubmitted() {
+    if (encodedSlot >= 0) {
+        submitted.push_back(static_cast<size_t>(encodedSlot));
+        encodedSlot = -1;
+    }
+    RequestMaps(kMapDelay);
+    Poll();
+}
+
+void FrameCapture::RequestMaps(size_t keep) {
+    while (submitted.size() > keep) {
+        Slot* slot = &slots[submitted.front()];
+        submitted.pop_front();
+        slot->state = SlotState::Mapping;
+        slot->buffer.MapAsync(wgpu::MapMode::Read, 0, slot->buffer.GetSize(), wgpu::CallbackMode::AllowSpontaneous,
+            [this, slot](wgpu::MapAsyncStatus status, wgpu::StringView) {
+                if (status != wgpu::MapAsyncStatus::Success) {
+                    writeFailed = true;
+                }
+                slot->state = SlotState::Mapped;
+            });
+    }
+}
+
+void FrameCapture::Poll() {
+    device.Tick();
+
+    // Deliver in capture order; stop at the first slot that is not mapped yet.
+    while (slots[nextToDeliver].state == SlotState::Mapped) {
+        Slot& slot = slots[nextToDeliver];
+        const uint8_t* mapped = static_cast<const uint8_t*>(slot.buffer.GetConstMappedRange(0, slot.buffer.GetSize()));
+        if (mapped) {
+            Frame frame;
+            frame.index = slot.frameIndex;
+            frame.bgra.resize(static_cast<size_t>(width) * height * 4);
+            for (uint32_t y = 0; y < height; ++y) {
+                std::memcpy(frame.bgra.data() + static_cast<size_t>(y) * width * 4,
+                            mapped + static_cast<size_t>(y) * paddedBytesPerRow, width * 4);
+            }
+            slot.buffer.Unmap();
+            slot.state = SlotState::Free;
+            encodeQueue->Push(std::move(frame));
+        } else {
+            slot.state = SlotState::Free;
+        }
+        nextToDeliver = (nextToDeliver + 1) % kRingSize;
+    }
+}
+
+bool FrameCapture::Finish() {
+    RequestMaps(0);
+    for (size_t i = 0; i < kRingSize; ++i) {
+        while (slots[i].state != SlotState::Free) {
+            Poll();
+            std::this_thread::yield();
+        }
+    }
+
+    encodeQueue->Close();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    return !writeFailed;
+}
+
+void FrameCapture::WorkerLoop() {
+    Frame frame;
+    while (encodeQueue->Pop(frame)) {
+        if (WriteFrame(frame)) {
+            ++framesWritten;
+        } else {
+            writeFailed = true;
+        }
+    }
+}
+
+bool FrameCapture::WriteFrame(const Frame& frame) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05llu.%s", static_cast<unsigned long long>(frame.index),
+                  format == CaptureFormat::Png ? "png" : "rgba");
+    std::string filename = (std::filesystem::path(outputDir) / name).string();
+
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    const uint8_t* bgra = frame.bgra.data();
+    bool ok = false;
+    if (format == CaptureFormat::Png) {
+        std::vector<uint8_t> rgb(pixelCount * 3);
+        for (size_t i = 0; i < pixelCount; ++i) {
+            rgb[i * 3 + 0] = bgra[i * 4 + 2];
+            rgb[i * 3 + 1] = bgra[i * 4 + 1];
+            rgb[i * 3 + 2] = bgra[i * 4 + 0];
+        }
+        ok = WritePng(filename, width, height, rgb.data());
+    } else {
+        std::vector<uint8_t> rgba(frame.bgra);
+        for (size_t i = 0; i < pixelCount; ++i) {
+            std::swap(rgba[i * 4 + 0], rgba[i * 4 + 2]);
+        }
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(rgba.data()), rgba.size());
+        ok = static_cast<bool>(file);
+    }
+
+    if (!ok) {
+        std::cerr << "Failed to write " << filename << std::endl;
+    }
+    return ok;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include "BoundedQueue.h"
+
+enum class CaptureFormat {
+    Png,
+    Raw, // tightly packed RGBA8 rows
+};
+
+// Copies rendered frames into a ring of readback buffers without stalling the
+// render loop. Each copy is mapped with MapAsync a few frames after it was
+// submitted, and the pixels are encoded and written by worker threads.
+class FrameCapture {
+public:
+    FrameCapture() = default;
+    ~FrameCapture();
+
+    bool Initialize(const wgpu::Device& device, uint32_t width, uint32_t height,
+                    const std::string& outputDir, CaptureFormat format, size_t workerCount);
+
+    // Records a copy of texture (BGRA8Unorm, width x height) into a free ring
+    // slot. Only waits if every slot is still in flight.
+    void EncodeCopy(const wgpu::CommandEncoder& encoder, const wgpu::Texture& texture);
+
+    // Call after the encoder passed to EncodeCopy has been submitted.
+    void OnSubmitted();
+
+    // Hands mapped frames to the workers. Never blocks on the GPU.
+    void Poll();
+
+    // Waits for every captured frame to be written and stops the workers.
+    // Returns false if any frame failed to write.
+    bool Finish();
+
+    uint64_t FramesWritten() const { return framesWritten; }
+
+private:
+    // Slots in the readback ring, and how many frames a copy waits before it is mapped.
+    static constexpr size_t kRingSize = 6;
+    static constexpr size_t kMapDelay = 2;
+    static constexpr size_t kEncodeQueueDepth = 4;
+
+    enum class SlotState { Free, Copying, Mapping, Mapped };
+
+    struct Slot {
+        wgpu::Buffer buffer;
+        std::atomic<SlotState> state = SlotState::Free;
+        uint64_t frameIndex = 0;
+    };
+
+    struct Frame {
+        uint64_t index = 0;
+        std::vector<uint8_t> bgra; // tightly packed rows
+    };
+
+    // Issues MapAsync for submitted copies, leaving the newest keep unmapped.
+    void RequestMaps(size_t keep);
+    void WorkerLoop();
+    bool WriteFrame(const Frame& frame);
+
+    wgpu::Device device;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t paddedBytesPerRow = 0;
+    std::string outputDir;
+    CaptureFormat format = CaptureFormat::Png;
+
+    std::unique_ptr<Slot[]> slots;
+    size_t nextSlot = 0;
+    size_t nextToDeliver = 0;
+    int encodedSlot = -1;
+    std::deque<size_t> submitted;
+    uint64_t framesCaptured = 0;
+
+    std::unique_ptr<BoundedQueue<Frame>> encodeQueue;
+    std::vector<std::thread> workers;
+    std::atomic<uint64_t> framesWritten = 0;
+    std::atomic<bool> writeFailed = false;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cmath>
+
+// Column-major 4x4 matrix: m[column * 4 + row]
+struct Mat4 {
+    float m[16];
+
+    static Mat4 Identity() {
+        Mat4 res = {};
+        res.m[0] = 1.0f; res.m[5] = 1.0f; res.m[10] = 1.0f; res.m[15] = 1.0f;
+        return res;
+    }
+
+    static Mat4 Perspective(float fovY, float aspect, float nearZ, float farZ) {
+        float f = 1.0f / std::tan(fovY / 2.0f);
+        Mat4 res = {};
+        res.m[0] = f / aspect;
+        res.m[5] = f;
+        res.m[10] = farZ / (nearZ - farZ);
+        res.m[11] = -1.0f;
+        res.m[14] = (farZ * nearZ) / (nearZ - farZ);
+        return res;
+    }
+
+    static Mat4 Translation(float x, float y, float z) {
+        Mat4 res = Identity();
+        res.m[12] = x; res.m[13] = y; res.m[14] = z;
+        return res;
+    }
+
+    static Mat4 Scale(float s) {
+        Mat4 res = Identity();
+        res.m[0] = s; res.m[5] = s; res.m[10] = s;
+        return res;
+    }
+
+    static Mat4 RotationX(float angle) {
+        Mat4 res = Identity();
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+        res.m[5] = c; res.m[6] = s;
+        res.m[9] = -s; res.m[10] = c;
+        return res;
+    }
+
+    static Mat4 RotationY(float angle) {
+        Mat4 res = Identity();
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+        res.m[0] = c; res.m[2] = -s;
+        res.m[8] = s; res.m[10] = c;
+        return res;
+    }
+
+    Mat4 Transpose() const {
+        Mat4 res = {};
+        for (int r = 0; r < 4; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                res.m[r * 4 + c] = m[c * 4 + r];
+            }
+        }
+        return res;
+    }
+
+    Mat4 operator*(const Mat4& other) const {
+        Mat4 res = {};
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                res.m[c * 4 + r] = 
+                    m[0 * 4 + r] * other.m[c * 4 + 0] +
+                    m[1 * 4 + r] * other.m[c * 4 + 1] +
+                    m[2 * 4 + r] * other.m[c * 4 + 2] +
+                    m[3 * 4 + r] * other.m[c * 4 + 3];
+            }
+        }
+        return res;
+    }
+};
@@ -1,29 +1,91 @@
 #include "PlyLoader.h"
 #include <iostream>
-#include <fstream>
 #include <sstream>
 #include <string>
+#include <cstring>
+#include <algorithm>
 
-bool PlyLoader::Load(const std::string& filename, std::vector<Vertex>& outVertices) {
-    std::ifstream file(filename, std::ios::binary);
+namespace {
+    size_t PropertySize(const std::string& type) {
+        if (type == "char" || type == "uchar" || type == "int8" || type == "uint8") return 1;
+        if (type == "short" || type == "ushort" || type == "int16" || type == "uint16") return 2;
+        if (type == "int" || type == "uint" || type == "int32" || type == "uint32") return 4;
+        if (type == "float" || type == "float32") return 4;
+        if (type == "double" || type == "float64") return 8;
+        return 0;
+    }
+
+    // Calls fn(index, value) for each of count records, dispatching on the
+    // property type once per column rather than once per value.
+    template <typename Fn>
+    void ForEachValue(const PlyProperty& prop, const char* records, size_t stride, size_t count, Fn fn) {
+        auto column = [&](auto zero) {
+            using T = decltype(zero);
+            const char* src = records + prop.offset;
+            for (size_t i = 0; i < count; ++i, src += stride) {
+                T value;
+                std::memcpy(&value, src, sizeof(T));
+                fn(i, static_cast<float>(value));
+            }
+        };
+        const std::string& t = prop.type;
+        if (t == "float" || t == "float32") column(float{});
+        else if (t == "double" || t == "float64") column(double{});
+        else if (t == "uchar" || t == "uint8") column(uint8_t{});
+        else if (t == "char" || t == "int8") column(int8_t{});
+        else if (t == "ushort" || t == "uint16") column(uint16_t{});
+        else if (t == "short" || t == "int16") column(int16_t{});
+        else if (t == "uint" || t == "uint32") column(uint32_t{});
+        else column(int32_t{});
+    }
+}
+
+bool PlyReader::Open(const std::string& filename) {
+    file.open(filename, std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "Failed to open PLY file: " << filename << std::endl;
         return false;
     }
 
     std::string line;
-    uint32_t vertexCount = 0;
     bool binary = false;
+    bool inVertexElement = false;
+    header = {};
 
     // Read header
     while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string keyword;
+        ss >> keyword;
         if (line.find("format binary_little_endian 1.0") != std::string::npos) {
             binary = true;
-        } else if (line.find("element vertex") != std::string::npos) {
-            std::stringstream ss(line);
-            std::string temp;
-            ss >> temp >> temp >> vertexCount;
-        } else if (line.find("end_header") != std::string::npos) {
+        } else if (keyword == "element") {
+            std::string name;
+            ss >> name;
+            inVertexElement = (name == "vertex");
+            if (inVertexElement) {
+                ss >> header.vertexCount;
+            } else if (header.vertexCount == 0) {
+                std::cerr << "Elements before 'vertex' are not supported" << std::endl;
+                return false;
+            }
+        } else if (keyword == "property" && inVertexElement) {
+            PlyProperty prop;
+            ss >> prop.type;
+            if (prop.type == "list") {
+                std::cerr << "List properties in the vertex element are not supported" << std::endl;
+                return false;
+            }
+            ss >> prop.name;
+            prop.size = PropertySize(prop.type);
+            if (prop.size == 0) {
+                std::cerr << "Unknown property type: " << prop.type << std::endl;
+                return false;
+            }
+            prop.offset = header.vertexStride;
+            header.vertexStride += prop.size;
+            header.properties.push_back(prop);
+        } else if (keyword == "end_header") {
             break;
         }
     }
@@ -33,18 +95,107 @@ bool PlyLoader::Load(const std::string& filename, std::vector<Vertex>& outVertic
         return false;
     }
 
-    if (vertexCount == 0) {
+    if (header.vertexCount == 0) {
         std::cerr << "No vertices found" << std::endl;
         return false;
     }
 
-    outVertices.resize(vertexCount);
-    file.read(reinterpret_cast<char*>(outVertices.data()), vertexCount * sizeof(Vertex));
+    roles.clear();
+    scalarNames.clear();
+    hasNormals = hasColors = false;
+    bool hasX = false, hasY = false, hasZ = false;
+    for (const auto& prop : header.properties) {
+        const std::string& name = prop.name;
+        if (name == "x") { roles.push_back(Role::PositionX); hasX = true; }
+        else if (name == "y") { roles.push_back(Role::PositionY); hasY = true; }
+        else if (name == "z") { roles.push_back(Role::PositionZ); hasZ = true; }
+        else if (name == "nx") { roles.push_back(Role::NormalX); hasNormals = true; }
+        else if (name == "ny") { roles.push_back(Role::NormalY); hasNormals = true; }
+        else if (name == "nz") { roles.push_back(Role::NormalZ); hasNormals = true; }
+        else if (name == "red") { roles.push_back(Role::Red); hasColors = true; }
+        else if (name == "green") { roles.push_back(Role::Green); hasColors = true; }
+        else if (name == "blue") { roles.push_back(Role::Blue); hasColors = true; }
+        else if (name == "alpha") { roles.push_back(Role::Alpha); hasColors = true; }
+        else {
+            roles.push_back(Role::Scalar);
+            scalarNames.push_back(name);
+        }
+    }
+
+    if (!hasX || !hasY || !hasZ) {
+        std::cerr << "Vertex element must have x, y and z properties" << std::endl;
+        return false;
+    }
+
+    remaining = header.vertexCount;
+    return true;
+}
+
+bool PlyReader::Read(PointCloud& outCloud, size_t maxVertices) {
+    size_t count = std::min<size_t>(maxVertices, remaining);
 
+    outCloud.positions.resize(count);
+    outCloud.normals.resize(hasNormals ? count : 0);
+    // Opaque unless the file has an alpha property
+    outCloud.colors.assign(hasColors ? count : 0, 0xFF000000u);
+    outCloud.scalarFields.resize(scalarNames.size());
+    for (size_t i = 0; i < scalarNames.size(); ++i) {
+        outCloud.scalarFields[i].name = scalarNames[i];
+        outCloud.scalarFields[i].values.resize(count);
+    }
+    if (count == 0) return true;
+
+    raw.resize(count * header.vertexStride);
+    file.read(raw.data(), raw.size());
     if (!file) {
         std::cerr << "Failed to read binary data" << std::endl;
         return false;
     }
+    remaining -= static_cast<uint32_t>(count);
+
+    // De-interleave one property at a time so each column is written contiguously.
+    const size_t stride = header.vertexStride;
+    size_t scalarIndex = 0;
+    for (size_t p = 0; p < header.properties.size(); ++p) {
+        const PlyProperty& prop = header.properties[p];
+        const char* src = raw.data();
+        auto& pos = outCloud.positions;
+        auto& nrm = outCloud.normals;
+        switch (roles[p]) {
+        case Role::PositionX: ForEachValue(prop, src, stride, count, [&](size_t i, float v) { pos[i].x = v; }); break;
+        case Role::PositionY: ForEachValue(prop, src, stride, count, [&](size_t i, float v) { pos[i].y = v; }); break;
+        case Role::PositionZ: ForEachValue(prop, src, stride, count, [&](size_t i, float v) { pos[i].z = v; }); break;
+        case Role::NormalX: ForEachValue(prop, src, stride, count, [&](size_t i, float v) { nrm[i].x = v; }); break;
+        case Role::NormalY: ForEachValue(prop, src, stride, count, [&](size_t i, float v) { nrm[i].y = v; }); break;
+        case Role::NormalZ: ForEachValue(prop, src, stride, count, [&](size_t i, float v) { nrm[i].z = v; }); break;
+        case Role::Red:
+        case Role::Green:
+        case Role::Blue:
+        case Role::Alpha: {
+            int shift = 8 * (static_cast<int>(roles[p]) - static_cast<int>(Role::Red));
+            uint32_t mask = ~(0xFFu << shift);
+            auto& colors = outCloud.colors;
+            ForEachValue(prop, src, stride, count, [&](size_t i, float v) {
+                uint32_t channel = static_cast<uint32_t>(std::clamp(v, 0.0f, 255.0f));
+                colors[i] = (colors[i] & mask) | (channel << shift);
+            });
+            break;
+        }
+        case Role::Scalar: {
+            std::vector<float>& values = outCloud.scalarFields[scalarIndex++].values;
+            ForEachValue(prop, src, stride, count, [&](size_t i, float v) { values[i] = v; });
+            break;
+        }
+        }
+    }
 
     return true;
 }
+
+bool PlyLoader::Load(const std::string& filename, PointCloud& outCloud) {
+    PlyReader reader;
+    if (!reader.Open(filename)) {
+        return false;
+    }
+    return reader.Read(outCloud, reader.Header().vertexCount);
+}
@@ -3,13 +3,49 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <fstream>
+#include "PointCloud.h"
 
-struct Vertex {
-    float x, y, z;
-    float intensity;
+struct PlyProperty {
+    std::string name;
+    std::string type;
+    size_t offset = 0;
+    size_t size = 0;
+};
+
+struct PlyHeader {
+    uint32_t vertexCount = 0;
+    size_t vertexStride = 0;
+    std::vector<PlyProperty> properties;
+};
+
+// Streams the vertex element of a binary_little_endian PLY in chunks.
+// x, y and z are required. nx/ny/nz become normals, red/green/blue(/alpha)
+// become colors and every other property becomes a float scalar field.
+class PlyReader {
+public:
+    bool Open(const std::string& filename);
+    const PlyHeader& Header() const { return header; }
+
+    // Reads up to maxVertices into outCloud (resized to the count read).
+    // Returns false on a read error; an empty result means end of data.
+    bool Read(PointCloud& outCloud, size_t maxVertices);
+
+private:
+    enum class Role { PositionX, PositionY, PositionZ, NormalX, NormalY, NormalZ,
+                      Red, Green, Blue, Alpha, Scalar };
+
+    std::ifstream file;
+    PlyHeader header;
+    uint32_t remaining = 0;
+    std::vector<Role> roles;
+    std::vector<std::string> scalarNames;
+    bool hasNormals = false;
+    bool hasColors = false;
+    std::vector<char> raw;
 };
 
 class PlyLoader {
 public:
-    static bool Load(const std::string& filename, std::vector<Vertex>& outVertices);
+    static bool Load(const std::string& filename, PointCloud& outCloud);
 };
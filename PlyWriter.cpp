@@ -0,0 +1,153 @@
+#include "PlyWriter.h"
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+namespace {
+    // Width of the zero-padded vertex count placeholder (fits any uint32_t)
+    constexpr int kCountWidth = 10;
+
+    size_t RecordSize(VertexLayout layout) {
+        switch (layout) {
+        case VertexLayout::XYZ: return sizeof(float) * 3;
+        case VertexLayout::XYZI: return sizeof(float) * 4;
+        case VertexLayout::XYZRGB: return sizeof(float) * 3 + 3;
+        }
+        return 0;
+    }
+
+    const char* LayoutName(VertexLayout layout) {
+        switch (layout) {
+        case VertexLayout::XYZ: return "xyz";
+        case VertexLayout::XYZI: return "xyzi";
+        case VertexLayout::XYZRGB: return "xyzrgb";
+        }
+        return "";
+    }
+
+    std::string FormatCount(uint64_t count) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%0*llu", kCountWidth, static_cast<unsigned long long>(count));
+        return buf;
+    }
+}
+
+bool ParseVertexLayout(const std::string& name, VertexLayout& outLayout) {
+    if (name == "xyz") outLayout = VertexLayout::XYZ;
+    else if (name == "xyzi") outLayout = VertexLayout::XYZI;
+    else if (name == "xyzrgb") outLayout = VertexLayout::XYZRGB;
+    else return false;
+    return true;
+}
+
+bool PlyWriter::Open(const std::string& filename, VertexLayout layout, bool writePlyHeader) {
+    this->layout = layout;
+    this->writePlyHeader = writePlyHeader;
+    count = 0;
+    attributesReported = false;
+
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open output file: " << filename << std::endl;
+        return false;
+    }
+    if (!writePlyHeader) return true;
+
+    file << "ply\n";
+    file << "format binary_little_endian 1.0\n";
+    file << "comment Created by ply_tool\n";
+    file << "element vertex ";
+    countPos = file.tellp();
+    file << FormatCount(0) << "\n";
+    file << "property float x\n";
+    file << "property float y\n";
+    file << "property float z\n";
+    if (layout == VertexLayout::XYZI) {
+        file << "property float intensity\n";
+    } else if (layout == VertexLayout::XYZRGB) {
+        file << "property uchar red\n";
+        file << "property uchar green\n";
+        file << "property uchar blue\n";
+    }
+    file << "end_header\n";
+    return static_cast<bool>(file);
+}
+
+bool PlyWriter::Write(const PointCloud& cloud) {
+    size_t recordSize = RecordSize(layout);
+    raw.resize(cloud.Size() * recordSize);
+    const ScalarField* intensity = cloud.PrimaryScalar();
+    if (!attributesReported && cloud.Size() > 0) {
+        ReportAttributes(cloud);
+    }
+
+    // Interleave the columns into the output records.
+    char* dst = raw.data();
+    for (size_t i = 0; i < cloud.Size(); ++i, dst += recordSize) {
+        std::memcpy(dst, &cloud.positions[i], sizeof(Float3));
+        if (layout == VertexLayout::XYZI) {
+            float value = intensity ? intensity->values[i] : 0.0f;
+            std::memcpy(dst + sizeof(Float3), &value, sizeof(float));
+        } else if (layout == VertexLayout::XYZRGB) {
+            uint32_t rgba = 0;
+            if (cloud.HasColors()) {
+                rgba = cloud.colors[i];
+            } else if (intensity) {
+                uint32_t grey = static_cast<uint32_t>(std::clamp(intensity->values[i], 0.0f, 255.0f));
+                rgba = grey | (grey << 8) | (grey << 16);
+            }
+            std::memcpy(dst + sizeof(Float3), &rgba, 3);
+        }
+    }
+    file.write(raw.data(), raw.size());
+
+    if (!file) {
+        std::cerr << "Failed to write binary data" << std::endl;
+        return false;
+    }
+    count += cloud.Size();
+    return true;
+}
+
+// Every chunk of a file has the same attributes, so the first non-empty one
+// is representative.
+void PlyWriter::ReportAttributes(const PointCloud& cloud) {
+    attributesReported = true;
+    const ScalarField* intensity = cloud.PrimaryScalar();
+    const char* name = LayoutName(layout);
+
+    std::string dropped;
+    auto drop = [&dropped](const std::string& attribute) {
+        dropped += dropped.empty() ? attribute : ", " + attribute;
+    };
+    if (layout != VertexLayout::XYZRGB && cloud.HasColors()) drop("rgb");
+    if (cloud.HasNormals()) drop("normals");
+    for (const auto& field : cloud.scalarFields) {
+        bool written = &field == intensity &&
+            (layout == VertexLayout::XYZI || (layout == VertexLayout::XYZRGB && !cloud.HasColors()));
+        if (!written) drop(field.name);
+    }
+    if (!dropped.empty()) {
+        std::cerr << "Warning: layout " << name << " drops " << dropped << std::endl;
+    }
+
+    if (layout == VertexLayout::XYZI && !intensity) {
+        std::cerr << "Warning: input has no scalar property; layout xyzi writes intensity 0" << std::endl;
+    } else if (layout == VertexLayout::XYZRGB && !cloud.HasColors() && !intensity) {
+        std::cerr << "Warning: input has no colors or scalar property; layout xyzrgb writes black" << std::endl;
+    }
+}
+
+bool PlyWriter::Close() {
+    if (writePlyHeader) {
+        if (count > UINT32_MAX) {
+            std::cerr << "Too many vertices for a PLY vertex count: " << count << std::endl;
+            return false;
+        }
+        file.seekp(countPos);
+        file << FormatCount(count);
+    }
+    file.close();
+    return !file.fail();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include "PlyLoader.h"
+
+enum class VertexLayout {
+    XYZ,    // float x, y, z
+    XYZI,   // float x, y, z, intensity (from PointCloud::PrimaryScalar, 0 without one)
+    XYZRGB, // float x, y, z + uchar red, green, blue (grey from the primary scalar without colors)
+};
+
+bool ParseVertexLayout(const std::string& name, VertexLayout& outLayout);
+
+// Writes points incrementally as binary_little_endian PLY or headerless raw
+// records. The PLY vertex count is patched in Close(), so the total does not
+// need to be known up front. Attributes the layout cannot carry, or is missing,
+// are reported once on stderr.
+class PlyWriter {
+public:
+    bool Open(const std::string& filename, VertexLayout layout, bool writePlyHeader);
+    bool Write(const PointCloud& cloud);
+    bool Close();
+    uint64_t Count() const { return count; }
+
+private:
+    void ReportAttributes(const PointCloud& cloud);
+
+    std::ofstream file;
+    VertexLayout layout = VertexLayout::XYZI;
+    bool writePlyHeader = true;
+    std::streampos countPos;
+    uint64_t count = 0;
+    bool attributesReported = false;
+    std::vector<char> raw;
+};
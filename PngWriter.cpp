@@ -0,0 +1,107 @@
+#include "PngWriter.h"
+#include <fstream>
+#include <vector>
+#include <array>
+#include <algorithm>
+
+namespace {
+    // Largest payload of a stored (uncompressed) deflate block
+    constexpr size_t kMaxStoredBlock = 65535;
+    // Bytes that can be summed before the Adler-32 sums may overflow 32 bits
+    constexpr size_t kAdlerBlock = 5552;
+
+    const std::array<uint32_t, 256>& CrcTable() {
+        static const std::array<uint32_t, 256> table = [] {
+            std::array<uint32_t, 256> t = {};
+            for (uint32_t n = 0; n < 256; ++n) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                t[n] = c;
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size) {
+        const auto& table = CrcTable();
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i) {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    void PutU32(std::vector<uint8_t>& out, uint32_t v) {
+        out.push_back(static_cast<uint8_t>(v >> 24));
+        out.push_back(static_cast<uint8_t>(v >> 16));
+        out.push_back(static_cast<uint8_t>(v >> 8));
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    void WriteChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data) {
+        std::vector<uint8_t> chunk;
+        chunk.reserve(data.size() + 12);
+        PutU32(chunk, static_cast<uint32_t>(data.size()));
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+        PutU32(chunk, Crc32(0, chunk.data() + 4, data.size() + 4));
+        file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+    }
+}
+
+bool WritePng(const std::string& filename, uint32_t width, uint32_t height, const uint8_t* rgb) {
+    if (width == 0 || height == 0) return false;
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    std::vector<uint8_t> header;
+    PutU32(header, width);
+    PutU32(header, height);
+    header.insert(header.end(), {8, 2, 0, 0, 0}); // 8-bit RGB, deflate, no filter, no interlace
+    WriteChunk(file, "IHDR", header);
+
+    // Scanlines with a leading "None" filter byte
+    size_t rowSize = static_cast<size_t>(width) * 3;
+    std::vector<uint8_t> raw((rowSize + 1) * height);
+    for (uint32_t y = 0; y < height; ++y) {
+        raw[y * (rowSize + 1)] = 0;
+        std::copy_n(rgb + y * rowSize, rowSize, raw.begin() + y * (rowSize + 1) + 1);
+    }
+
+    // zlib stream made of stored deflate blocks
+    std::vector<uint8_t> idat;
+    idat.reserve(raw.size() + raw.size() / kMaxStoredBlock * 5 + 16);
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+    uint32_t adlerA = 1, adlerB = 0;
+    for (size_t offset = 0; offset < raw.size(); offset += kMaxStoredBlock) {
+        size_t size = std::min(kMaxStoredBlock, raw.size() - offset);
+        bool last = offset + size == raw.size();
+        idat.push_back(last ? 1 : 0);
+        idat.push_back(static_cast<uint8_t>(size));
+        idat.push_back(static_cast<uint8_t>(size >> 8));
+        idat.push_back(static_cast<uint8_t>(~size));
+        idat.push_back(static_cast<uint8_t>(~size >> 8));
+        idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + size);
+    }
+    for (size_t offset = 0; offset < raw.size(); offset += kAdlerBlock) {
+        size_t end = std::min(offset + kAdlerBlock, raw.size());
+        for (size_t i = offset; i < end; ++i) {
+            adlerA += raw[i];
+            adlerB += adlerA;
+        }
+        adlerA %= 65521;
+        adlerB %= 65521;
+    }
+    PutU32(idat, (adlerB << 16) | adlerA);
+    WriteChunk(file, "IDAT", idat);
+    WriteChunk(file, "IEND", {});
+
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+// Writes 8-bit RGB pixels (tightly packed rows) as a PNG. The image data is
+// stored uncompressed, which keeps encoding cheap enough for frame dumps.
+bool WritePng(const std::string& filename, uint32_t width, uint32_t height, const uint8_t* rgb);
@@ -0,0 +1,62 @@
+#include "PointCloud.h"
+
+namespace {
+    template <typename T>
+    void CompactColumn(std::vector<T>& column, const std::vector<uint8_t>& keep) {
+        if (column.empty()) return;
+        // Branchless: always copy, advance only for kept points.
+        size_t out = 0;
+        for (size_t i = 0; i < column.size(); ++i) {
+            column[out] = column[i];
+            out += keep[i] ? 1 : 0;
+        }
+        column.resize(out);
+    }
+
+    template <typename T>
+    void SubsampleColumn(std::vector<T>& column, size_t first, size_t stride) {
+        if (column.empty()) return;
+        size_t out = 0;
+        for (size_t i = first; i < column.size(); i += stride) {
+            column[out++] = column[i];
+        }
+        column.resize(out);
+    }
+}
+
+const ScalarField* PointCloud::FindScalarField(const std::string& name) const {
+    for (const auto& field : scalarFields) {
+        if (field.name == name) return &field;
+    }
+    return nullptr;
+}
+
+const ScalarField* PointCloud::Intensity() const {
+    for (const auto& field : scalarFields) {
+        if (field.name.find("intensity") != std::string::npos) return &field;
+    }
+    return nullptr;
+}
+
+const ScalarField* PointCloud::PrimaryScalar() const {
+    if (const ScalarField* intensity = Intensity()) return intensity;
+    return scalarFields.empty() ? nullptr : &scalarFields[0];
+}
+
+void PointCloud::Compact(const std::vector<uint8_t>& keep) {
+    CompactColumn(positions, keep);
+    CompactColumn(normals, keep);
+    CompactColumn(colors, keep);
+    for (auto& field : scalarFields) {
+        CompactColumn(field.values, keep);
+    }
+}
+
+void PointCloud::Subsample(size_t first, size_t stride) {
+    SubsampleColumn(positions, first, stride);
+    SubsampleColumn(normals, first, stride);
+    SubsampleColumn(colors, first, stride);
+    for (auto& field : scalarFields) {
+        SubsampleColumn(field.values, first, stride);
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+struct Float3 {
+    float x, y, z;
+};
+
+struct ScalarField {
+    std::string name;
+    std::vector<float> values;
+};
+
+// Columnar point cloud: one contiguous array per attribute. Optional
+// attributes are empty when absent; present ones always have Size() entries.
+struct PointCloud {
+    std::vector<Float3> positions;
+    std::vector<Float3> normals;
+    std::vector<uint32_t> colors; // packed RGBA8, red in the low byte
+    std::vector<ScalarField> scalarFields;
+
+    size_t Size() const { return positions.size(); }
+    bool HasNormals() const { return !normals.empty(); }
+    bool HasColors() const { return !colors.empty(); }
+
+    const ScalarField* FindScalarField(const std::string& name) const;
+
+    // The first scalar field whose name contains "intensity", if any.
+    const ScalarField* Intensity() const;
+
+    // Intensity() if present, otherwise the first scalar field, if any.
+    const ScalarField* PrimaryScalar() const;
+
+    // Keeps the points whose mask entry is non-zero, preserving order.
+    void Compact(const std::vector<uint8_t>& keep);
+
+    // Keeps every stride-th point starting at first.
+    void Subsample(size_t first, size_t stride);
+};
@@ -0,0 +1,114 @@
+#include "PointOps.h"
+#include <algorithm>
+#include <cfloat>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define PLY_USE_SSE 1
+#endif
+
+namespace {
+    static_assert(sizeof(Float3) == sizeof(float) * 3, "Float3 must be tightly packed");
+
+#ifdef PLY_USE_SSE
+    // result = [a[i0], a[i1], b[i2], b[i3]]
+    #define SHUFFLE(a, b, i0, i1, i2, i3) _mm_shuffle_ps(a, b, _MM_SHUFFLE(i3, i2, i1, i0))
+
+    __m128 Row(const float* m, int r, __m128 x, __m128 y, __m128 z, __m128 w) {
+        return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[r]), x), _mm_mul_ps(_mm_set1_ps(m[4 + r]), y)),
+                                     _mm_mul_ps(_mm_set1_ps(m[8 + r]), z)), w);
+    }
+#endif
+
+    void TransformFloat3(const Mat4& t, bool translate, std::vector<Float3>& points) {
+        const float* m = t.m;
+        float tx = translate ? m[12] : 0.0f;
+        float ty = translate ? m[13] : 0.0f;
+        float tz = translate ? m[14] : 0.0f;
+        size_t i = 0;
+#ifdef PLY_USE_SSE
+        // Four points are three registers: [x0 y0 z0 x1] [y1 z1 x2 y2] [z2 x3 y3 z3].
+        // Deinterleave to x/y/z, transform, and interleave back.
+        __m128 wx = _mm_set1_ps(tx), wy = _mm_set1_ps(ty), wz = _mm_set1_ps(tz);
+        float* data = reinterpret_cast<float*>(points.data());
+        for (; i + 4 <= points.size(); i += 4) {
+            float* p = data + i * 3;
+            __m128 p0 = _mm_loadu_ps(p + 0);
+            __m128 p1 = _mm_loadu_ps(p + 4);
+            __m128 p2 = _mm_loadu_ps(p + 8);
+
+            __m128 x = SHUFFLE(p0, SHUFFLE(p1, p2, 2, 0, 1, 0), 0, 3, 0, 2);
+            __m128 y = SHUFFLE(SHUFFLE(p0, p1, 1, 0, 0, 0), SHUFFLE(p1, p2, 3, 0, 2, 0), 0, 2, 0, 2);
+            __m128 z = SHUFFLE(SHUFFLE(p0, p1, 2, 0, 1, 0), SHUFFLE(p2, p2, 0, 0, 3, 0), 0, 2, 0, 2);
+
+            __m128 rx = Row(m, 0, x, y, z, wx);
+            __m128 ry = Row(m, 1, x, y, z, wy);
+            __m128 rz = Row(m, 2, x, y, z, wz);
+
+            _mm_storeu_ps(p + 0, SHUFFLE(SHUFFLE(rx, ry, 0, 0, 0, 0), SHUFFLE(rz, rx, 0, 0, 1, 0), 0, 2, 0, 2));
+            _mm_storeu_ps(p + 4, SHUFFLE(SHUFFLE(ry, rz, 1, 0, 1, 0), SHUFFLE(rx, ry, 2, 0, 2, 0), 0, 2, 0, 2));
+            _mm_storeu_ps(p + 8, SHUFFLE(SHUFFLE(rz, rx, 2, 0, 3, 0), SHUFFLE(ry, rz, 3, 0, 3, 0), 0, 2, 0, 2));
+        }
+#undef SHUFFLE
+#endif
+        for (; i < points.size(); ++i) {
+            Float3& v = points[i];
+            float x = v.x, y = v.y, z = v.z;
+            v.x = m[0] * x + m[4] * y + m[8] * z + tx;
+            v.y = m[1] * x + m[5] * y + m[9] * z + ty;
+            v.z = m[2] * x + m[6] * y + m[10] * z + tz;
+        }
+    }
+}
+
+Aabb ComputeBounds(const std::vector<Float3>& positions) {
+    Aabb box = {FLT_MAX, FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (const auto& p : positions) {
+        box.minX = std::min(box.minX, p.x); box.maxX = std::max(box.maxX, p.x);
+        box.minY = std::min(box.minY, p.y); box.maxY = std::max(box.maxY, p.y);
+        box.minZ = std::min(box.minZ, p.z); box.maxZ = std::max(box.maxZ, p.z);
+    }
+    return box;
+}
+
+void NormalizePositions(std::vector<Float3>& positions, float halfExtent) {
+    if (positions.empty()) return;
+    Aabb box = ComputeBounds(positions);
+
+    float centerX = (box.minX + box.maxX) / 2.0f;
+    float centerY = (box.minY + box.maxY) / 2.0f;
+    float centerZ = (box.minZ + box.maxZ) / 2.0f;
+    float maxExtent = std::max({box.maxX - box.minX, box.maxY - box.minY, box.maxZ - box.minZ});
+    float scale = maxExtent > 0.0f ? 2.0f * halfExtent / maxExtent : 1.0f;
+
+    for (auto& p : positions) {
+        p.x = (p.x - centerX) * scale;
+        p.y = (p.y - centerY) * scale;
+        p.z = (p.z - centerZ) * scale;
+    }
+}
+
+void TransformPoints(const Mat4& transform, PointCloud& cloud) {
+    TransformFloat3(transform, true, cloud.positions);
+    TransformFloat3(transform, false, cloud.normals);
+}
+
+void CropPoints(const Aabb& box, PointCloud& cloud) {
+    std::vector<uint8_t> keep(cloud.Size());
+    for (size_t i = 0; i < keep.size(); ++i) {
+        const Float3& p = cloud.positions[i];
+        keep[i] = p.x >= box.minX && p.x <= box.maxX &&
+                  p.y >= box.minY && p.y <= box.maxY &&
+                  p.z >= box.minZ && p.z <= box.maxZ;
+    }
+    cloud.Compact(keep);
+}
+
+void SubsamplePoints(uint32_t stride, uint64_t& offset, PointCloud& cloud) {
+    size_t count = cloud.Size();
+    if (stride > 1) {
+        size_t first = static_cast<size_t>((stride - offset % stride) % stride);
+        cloud.Subsample(first, stride);
+    }
+    offset += count;
+}
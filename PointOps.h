@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "PointCloud.h"
+#include "Mat4.h"
+
+struct Aabb {
+    float minX, minY, minZ;
+    float maxX, maxY, maxZ;
+};
+
+// Bounding box of the positions; inverted (min > max) when empty.
+Aabb ComputeBounds(const std::vector<Float3>& positions);
+
+// Centers the positions on the origin and scales the largest extent to
+// 2 * halfExtent, as done before upload in Renderer::SetPointCloud.
+void NormalizePositions(std::vector<Float3>& positions, float halfExtent);
+
+// Applies an affine transform to positions and its linear part to normals
+// (exact for rigid transforms). Points are processed four at a time with
+// SIMD where available.
+void TransformPoints(const Mat4& transform, PointCloud& cloud);
+
+// Removes points outside the box (bounds inclusive), preserving order.
+void CropPoints(const Aabb& box, PointCloud& cloud);
+
+// Keeps every stride-th point. offset is the global index of the first point
+// and is advanced so that consecutive chunks subsample as one continuous stream.
+void SubsamplePoints(uint32_t stride, uint64_t& offset, PointCloud& cloud);
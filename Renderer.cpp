@@ -1,4 +1,6 @@
 #include "Renderer.h"
+#include "Mat4.h"
+#include "PointOps.h"
 #include <webgpu/webgpu_glfw.h>
 #include <dawn/native/DawnNative.h>
 #include <GLFW/glfw3.h>
@@ -6,91 +8,16 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
-#include <cfloat>
-
-namespace {
-    struct Mat4 {
-        float m[16];
-
-        static Mat4 Identity() {
-            Mat4 res = {};
-            res.m[0] = 1.0f; res.m[5] = 1.0f; res.m[10] = 1.0f; res.m[15] = 1.0f;
-            return res;
-        }
-
-        static Mat4 Perspective(float fovY, float aspect, float nearZ, float farZ) {
-            float f = 1.0f / std::tan(fovY / 2.0f);
-            Mat4 res = {};
-            res.m[0] = f / aspect;
-            res.m[5] = f;
-            res.m[10] = farZ / (nearZ - farZ);
-            res.m[11] = -1.0f;
-            res.m[14] = (farZ * nearZ) / (nearZ - farZ);
-            return res;
-        }
-
-        static Mat4 Translation(float x, float y, float z) {
-            Mat4 res = Identity();
-            res.m[12] = x; res.m[13] = y; res.m[14] = z;
-            return res;
-        }
-
-        static Mat4 Scale(float s) {
-            Mat4 res = Identity();
-            res.m[0] = s; res.m[5] = s; res.m[10] = s;
-            return res;
-        }
-
-        static Mat4 RotationX(float angle) {
-            Mat4 res = Identity();
-            float c = std::cos(angle);
-            float s = std::sin(angle);
-            res.m[5] = c; res.m[6] = s;
-            res.m[9] = -s; res.m[10] = c;
-            return res;
-        }
-
-        static Mat4 RotationY(float angle) {
-            Mat4 res = Identity();
-            float c = std::cos(angle);
-            float s = std::sin(angle);
-            res.m[0] = c; res.m[2] = -s;
-            res.m[8] = s; res.m[10] = c;
-            return res;
-        }
-
-        Mat4 Transpose() const {
-            Mat4 res = {};
-            for (int r = 0; r < 4; ++r) {
-                for (int c = 0; c < 4; ++c) {
-                    res.m[r * 4 + c] = m[c * 4 + r];
-                }
-            }
-            return res;
-        }
-
-        Mat4 operator*(const Mat4& other) const {
-            Mat4 res = {};
-            for (int c = 0; c < 4; ++c) {
-                for (int r = 0; r < 4; ++r) {
-                    res.m[c * 4 + r] = 
-                        m[0 * 4 + r] * other.m[c * 4 + 0] +
-                        m[1 * 4 + r] * other.m[c * 4 + 1] +
-                        m[2 * 4 + r] * other.m[c * 4 + 2] +
-                        m[3 * 4 + r] * other.m[c * 4 + 3];
-                }
-            }
-            return res;
-        }
-    };
-}
+#include <thread>
 
 
 Renderer::Renderer() {}
 
 Renderer::~Renderer() {}
 
-bool Renderer::Initialize(GLFWwindow* window, const std::string& preferredDevice) {
+bool Renderer::Initialize(GLFWwindow* window, const std::string& preferredDevice, uint32_t width, uint32_t height) {
+    this->width = width;
+    this->height = height;
     if (!InitDevice(preferredDevice)) return false;
     
     // Create uniform buffer
@@ -100,7 +27,8 @@ bool Renderer::Initialize(GLFWwindow* window, const std::string& preferredDevice
     uniformBuffer = device.CreateBuffer(&bufferDesc);
     UpdateUniforms();
 
-    if (!InitSurface(window)) return false;
+    // Without a window the renderer is headless and only renders for capture.
+    if (window && !InitSurface(window)) return false;
     if (!InitPipeline()) return false;
     return true;
 }
@@ -116,6 +44,28 @@ bool Renderer::InitDevice(const std::string& preferredDevice) {
     WGPUDevice cDevice = nullptr;
     std::string selectedName;
 
+    // Request implicit device synchronization when available so that render
+    // bundles can be recorded from worker threads (see RecordBundles).
+    auto createDevice = [this](dawn::native::Adapter adapter) -> WGPUDevice {
+        wgpu::FeatureName requiredFeature = wgpu::FeatureName::ImplicitDeviceSynchronization;
+        multithreadedEncoding = wgpuAdapterHasFeature(adapter.Get(), static_cast<WGPUFeatureName>(requiredFeature));
+
+        wgpu::DeviceDescriptor deviceDesc = {};
+        if (multithreadedEncoding) {
+            deviceDesc.requiredFeatureCount = 1;
+            deviceDesc.requiredFeatures = &requiredFeature;
+        }
+
+        // The defaults cap buffers at 256 MiB; large clouds need whatever the adapter allows.
+        wgpu::Limits supportedLimits = {};
+        wgpuAdapterGetLimits(adapter.Get(), reinterpret_cast<WGPULimits*>(&supportedLimits));
+        wgpu::Limits requiredLimits = {};
+        requiredLimits.maxBufferSize = supportedLimits.maxBufferSize;
+        requiredLimits.maxStorageBufferBindingSize = supportedLimits.maxStorageBufferBindingSize;
+        deviceDesc.requiredLimits = &requiredLimits;
+        return adapter.CreateDevice(&deviceDesc);
+    };
+
     // Helper to decode StringView
     auto decodeSV = [](wgpu::StringView sv) -> std::string {
         if (!sv.data) return "";
@@ -131,26 +81,30 @@ bool Renderer::InitDevice(const std::string& preferredDevice) {
             wgpuAdapterGetInfo(cAdapter, reinterpret_cast<WGPUAdapterInfo*>(&info));
             
             std::string deviceName = decodeSV(info.device);
-            if (deviceName.find(preferredDevice) != std::string::npos) {
+            // "cpu" picks the software adapter (e.g. SwiftShader) for headless use
+            bool isMatch = preferredDevice == "cpu" ? info.adapterType == wgpu::AdapterType::CPU
+                                                    : deviceName.find(preferredDevice) != std::string::npos;
+            if (isMatch) {
                 // dawn::native::Adapter is const, but CreateDevice is non-const. 
-                // We need to const_cast or copy since EnumerateAdapters returns vector of objects.
-                // Actually, let's just make a mutable copy or cast since we need to call non-const method.
-                // dawn::native::Adapter is a light wrapper.
-                auto mutableAdapter = adapter;
-                cDevice = mutableAdapter.CreateDevice();
+                // createDevice takes a copy; dawn::native::Adapter is a light wrapper.
+                cDevice = createDevice(adapter);
                 selectedName = deviceName;
                 std::cout << "Selected preferred device: " << selectedName << std::endl;
                 break;
             }
         }
+        // An explicit CPU request must not quietly end up on a GPU
+        if (!cDevice && preferredDevice == "cpu") {
+            std::cerr << "No CPU adapter found. Build Dawn with DAWN_ENABLE_SWIFTSHADER=ON." << std::endl;
+            return false;
+        }
         if (!cDevice) {
             std::cerr << "Preferred device '" << preferredDevice << "' not found. Falling back to default." << std::endl;
         }
     }
 
     if (!cDevice) {
-        auto mutableAdapter = adapters[0];
-        cDevice = mutableAdapter.CreateDevice();
+        cDevice = createDevice(adapters[0]);
         // Get name for logging
         wgpu::AdapterInfo info = {};
         WGPUAdapter cAdapter = adapters[0].Get();
@@ -161,6 +115,12 @@ bool Renderer::InitDevice(const std::string& preferredDevice) {
 
     device = wgpu::Device::Acquire(cDevice);
     queue = device.GetQueue();
+    std::cout << "Multithreaded bundle encoding: " << (multithreadedEncoding ? "enabled" : "disabled") << std::endl;
+
+    wgpu::Limits limits = {};
+    device.GetLimits(&limits);
+    maxBufferSize = limits.maxBufferSize;
+    std::cout << "Max buffer size: " << (maxBufferSize >> 20) << " MiB" << std::endl;
     
     return true;
 }
@@ -173,23 +133,20 @@ bool Renderer::InitSurface(GLFWwindow* window) {
     wgpu::SurfaceConfiguration config = {};
     config.device = device;
     config.format = format;
-    config.width = 800;
-    config.height = 600;
+    config.width = width;
+    config.height = height;
     config.usage = wgpu::TextureUsage::RenderAttachment;
     surface.Configure(&config);
 
     return true;
 }
 
+// One vertex entry point per color stream; each reads only its own stream.
 static const char* shaderCode = R"(
-struct VertexInput {
-    @location(0) position: vec3<f32>,
-    @location(1) intensity: f32,
-};
-
 struct VertexOutput {
     @builtin(position) position: vec4<f32>,
     @location(0) color: vec4<f32>,
+    @location(1) scalar: f32,
 };
 
 struct Uniforms {
@@ -197,19 +154,57 @@ struct Uniforms {
 };
 @group(0) @binding(0) var<uniform> uniforms : Uniforms;
 
-@vertex
-fn vs_main(input: VertexInput) -> VertexOutput {
+// Written by the GPU reduction passes (see ScalarReduction)
+struct ScalarRange {
+    minValue: f32,
+    maxValue: f32,
+    low: f32,
+    high: f32,
+};
+@group(0) @binding(1) var<storage, read> scalarRange : ScalarRange;
+@group(0) @binding(2) var colormap : texture_1d<f32>;
+@group(0) @binding(3) var colormapSampler : sampler;
+
+fn shade(position: vec3<f32>, color: vec3<f32>) -> VertexOutput {
     var output: VertexOutput;
-    output.position = uniforms.mvp * vec4<f32>(input.position, 1.0);
-    let c = input.intensity / 255.0;
-    output.color = vec4<f32>(c, c, c, 1.0);
+    output.position = uniforms.mvp * vec4<f32>(position, 1.0);
+    output.color = vec4<f32>(color, 1.0);
+    output.scalar = 0.0;
     return output;
 }
 
+@vertex
+fn vs_plain(@location(0) position: vec3<f32>) -> VertexOutput {
+    return shade(position, vec3<f32>(1.0, 1.0, 1.0));
+}
+
+@vertex
+fn vs_scalar(@location(0) position: vec3<f32>, @location(1) value: f32) -> VertexOutput {
+    var output = shade(position, vec3<f32>(1.0, 1.0, 1.0));
+    let width = scalarRange.high - scalarRange.low;
+    output.scalar = select(0.5, clamp((value - scalarRange.low) / width, 0.0, 1.0), width > 0.0);
+    return output;
+}
+
+@vertex
+fn vs_rgb(@location(0) position: vec3<f32>, @location(1) color: vec4<f32>) -> VertexOutput {
+    return shade(position, color.rgb);
+}
+
+@vertex
+fn vs_normal(@location(0) position: vec3<f32>, @location(1) normal: vec3<f32>) -> VertexOutput {
+    return shade(position, abs(normal));
+}
+
 @fragment
 fn fs_main(input: VertexOutput) -> @location(0) vec4<f32> {
     return input.color;
 }
+
+@fragment
+fn fs_colormap(input: VertexOutput) -> @location(0) vec4<f32> {
+    return textureSample(colormap, colormapSampler, input.scalar);
+}
 )";
 
 bool Renderer::InitPipeline() {
@@ -217,116 +212,306 @@ bool Renderer::InitPipeline() {
     wgpu::ShaderSourceWGSL wgslDesc = {};
     wgslDesc.code = shaderCode;
     shaderDesc.nextInChain = &wgslDesc;
-    wgpu::ShaderModule shaderModule = device.CreateShaderModule(&shaderDesc);
+    shaderModule = device.CreateShaderModule(&shaderDesc);
+
+    if (!scalarReduction.Initialize(device)) return false;
+    InitColormap();
 
+    // Create BindGroupLayout and BindGroup
+    wgpu::BindGroupLayoutEntry bindingLayouts[4] = {};
+    bindingLayouts[0].binding = 0;
+    bindingLayouts[0].visibility = wgpu::ShaderStage::Vertex;
+    bindingLayouts[0].buffer.type = wgpu::BufferBindingType::Uniform;
+    bindingLayouts[0].buffer.minBindingSize = sizeof(Uniforms);
+    bindingLayouts[1].binding = 1;
+    bindingLayouts[1].visibility = wgpu::ShaderStage::Vertex;
+    bindingLayouts[1].buffer.type = wgpu::BufferBindingType::ReadOnlyStorage;
+    bindingLayouts[1].buffer.minBindingSize = sizeof(ScalarRange);
+    bindingLayouts[2].binding = 2;
+    bindingLayouts[2].visibility = wgpu::ShaderStage::Fragment;
+    bindingLayouts[2].texture.sampleType = wgpu::TextureSampleType::Float;
+    bindingLayouts[2].texture.viewDimension = wgpu::TextureViewDimension::e1D;
+    bindingLayouts[3].binding = 3;
+    bindingLayouts[3].visibility = wgpu::ShaderStage::Fragment;
+    bindingLayouts[3].sampler.type = wgpu::SamplerBindingType::Filtering;
+
+    wgpu::BindGroupLayoutDescriptor bindGroupLayoutDesc = {};
+    bindGroupLayoutDesc.entryCount = 4;
+    bindGroupLayoutDesc.entries = bindingLayouts;
+    bindGroupLayout = device.CreateBindGroupLayout(&bindGroupLayoutDesc);
+
+    wgpu::PipelineLayoutDescriptor pipelineLayoutDesc = {};
+    pipelineLayoutDesc.bindGroupLayoutCount = 1;
+    pipelineLayoutDesc.bindGroupLayouts = &bindGroupLayout;
+    pipelineLayout = device.CreatePipelineLayout(&pipelineLayoutDesc);
+
+    wgpu::BindGroupEntry bindings[4] = {};
+    bindings[0].binding = 0;
+    bindings[0].buffer = uniformBuffer;
+    bindings[0].offset = 0;
+    bindings[0].size = sizeof(Uniforms);
+    bindings[1].binding = 1;
+    bindings[1].buffer = scalarReduction.RangeBuffer();
+    bindings[1].size = sizeof(ScalarRange);
+    bindings[2].binding = 2;
+    bindings[2].textureView = colormapTexture.CreateView();
+    bindings[3].binding = 3;
+    bindings[3].sampler = colormapSampler;
+
+    wgpu::BindGroupDescriptor bindGroupDesc = {};
+    bindGroupDesc.layout = bindGroupLayout;
+    bindGroupDesc.entryCount = 4;
+    bindGroupDesc.entries = bindings;
+    bindGroup = device.CreateBindGroup(&bindGroupDesc);
+
+    return CreateRenderPipeline();
+}
+
+void Renderer::InitColormap() {
+    // Polynomial approximation of the Turbo colormap
+    std::vector<uint8_t> texels(kColormapSize * 4);
+    for (uint32_t i = 0; i < kColormapSize; ++i) {
+        float t = static_cast<float>(i) / (kColormapSize - 1);
+        float r = 0.13572138f + t * (4.61539260f + t * (-42.66032258f + t * (132.13108234f + t * (-152.94239396f + t * 59.28637943f))));
+        float g = 0.09140261f + t * (2.19418839f + t * (4.84296658f + t * (-14.18503333f + t * (4.27729857f + t * 2.82956604f))));
+        float b = 0.10667330f + t * (12.64194608f + t * (-60.58204836f + t * (110.36276771f + t * (-89.90310912f + t * 27.34824973f))));
+        texels[i * 4 + 0] = static_cast<uint8_t>(std::clamp(r, 0.0f, 1.0f) * 255.0f + 0.5f);
+        texels[i * 4 + 1] = static_cast<uint8_t>(std::clamp(g, 0.0f, 1.0f) * 255.0f + 0.5f);
+        texels[i * 4 + 2] = static_cast<uint8_t>(std::clamp(b, 0.0f, 1.0f) * 255.0f + 0.5f);
+        texels[i * 4 + 3] = 255;
+    }
+
+    wgpu::TextureDescriptor textureDesc = {};
+    textureDesc.dimension = wgpu::TextureDimension::e1D;
+    textureDesc.size = {kColormapSize, 1, 1};
+    textureDesc.format = wgpu::TextureFormat::RGBA8Unorm;
+    textureDesc.usage = wgpu::TextureUsage::TextureBinding | wgpu::TextureUsage::CopyDst;
+    colormapTexture = device.CreateTexture(&textureDesc);
+
+    wgpu::TexelCopyTextureInfo destination = {};
+    destination.texture = colormapTexture;
+    wgpu::TexelCopyBufferLayout dataLayout = {};
+    dataLayout.bytesPerRow = kColormapSize * 4;
+    dataLayout.rowsPerImage = 1;
+    queue.WriteTexture(&destination, texels.data(), texels.size(), &dataLayout, &textureDesc.size);
+
+    wgpu::SamplerDescriptor samplerDesc = {};
+    samplerDesc.magFilter = wgpu::FilterMode::Linear;
+    samplerDesc.minFilter = wgpu::FilterMode::Linear;
+    colormapSampler = device.CreateSampler(&samplerDesc);
+}
+
+bool Renderer::CreateRenderPipeline() {
     wgpu::RenderPipelineDescriptor pipelineDesc = {};
-    
+
+    // Stream 0: positions. Stream 1: the active color attribute, if any.
     wgpu::VertexAttribute attributes[2];
     attributes[0].format = wgpu::VertexFormat::Float32x3;
     attributes[0].offset = 0;
     attributes[0].shaderLocation = 0;
-    attributes[1].format = wgpu::VertexFormat::Float32;
-    attributes[1].offset = sizeof(float) * 3;
+    attributes[1].offset = 0;
     attributes[1].shaderLocation = 1;
 
-    wgpu::VertexBufferLayout vertexBufferLayout = {};
-    vertexBufferLayout.arrayStride = sizeof(Vertex);
-    vertexBufferLayout.stepMode = wgpu::VertexStepMode::Vertex;
-    vertexBufferLayout.attributeCount = 2;
-    vertexBufferLayout.attributes = attributes;
+    wgpu::VertexBufferLayout vertexBufferLayouts[2] = {};
+    vertexBufferLayouts[0].arrayStride = sizeof(Float3);
+    vertexBufferLayouts[0].stepMode = wgpu::VertexStepMode::Vertex;
+    vertexBufferLayouts[0].attributeCount = 1;
+    vertexBufferLayouts[0].attributes = &attributes[0];
+    vertexBufferLayouts[1].stepMode = wgpu::VertexStepMode::Vertex;
+    vertexBufferLayouts[1].attributeCount = 1;
+    vertexBufferLayouts[1].attributes = &attributes[1];
+
+    const char* entryPoint = "vs_plain";
+    const char* fragmentEntryPoint = "fs_main";
+    switch (colorMode) {
+    case ColorMode::None:
+        break;
+    case ColorMode::Scalar:
+        entryPoint = "vs_scalar";
+        fragmentEntryPoint = "fs_colormap";
+        attributes[1].format = wgpu::VertexFormat::Float32;
+        vertexBufferLayouts[1].arrayStride = sizeof(float);
+        break;
+    case ColorMode::Rgb:
+        entryPoint = "vs_rgb";
+        attributes[1].format = wgpu::VertexFormat::Unorm8x4;
+        vertexBufferLayouts[1].arrayStride = sizeof(uint32_t);
+        break;
+    case ColorMode::Normal:
+        entryPoint = "vs_normal";
+        attributes[1].format = wgpu::VertexFormat::Float32x3;
+        vertexBufferLayouts[1].arrayStride = sizeof(Float3);
+        break;
+    }
 
     pipelineDesc.vertex.module = shaderModule;
-    pipelineDesc.vertex.entryPoint = "vs_main";
-    pipelineDesc.vertex.bufferCount = 1;
-    pipelineDesc.vertex.buffers = &vertexBufferLayout;
+    pipelineDesc.vertex.entryPoint = entryPoint;
+    pipelineDesc.vertex.bufferCount = colorMode == ColorMode::None ? 1 : 2;
+    pipelineDesc.vertex.buffers = vertexBufferLayouts;
 
     wgpu::ColorTargetState colorTarget = {};
     colorTarget.format = format;
     wgpu::FragmentState fragmentState = {};
     fragmentState.module = shaderModule;
-    fragmentState.entryPoint = "fs_main";
+    fragmentState.entryPoint = fragmentEntryPoint;
     fragmentState.targetCount = 1;
     fragmentState.targets = &colorTarget;
     pipelineDesc.fragment = &fragmentState;
 
     pipelineDesc.primitive.topology = wgpu::PrimitiveTopology::PointList;
+    pipelineDesc.layout = pipelineLayout;
 
-    // Create BindGroupLayout and BindGroup
-    wgpu::BindGroupLayoutEntry bindingLayout = {};
-    bindingLayout.binding = 0;
-    bindingLayout.visibility = wgpu::ShaderStage::Vertex;
-    bindingLayout.buffer.type = wgpu::BufferBindingType::Uniform;
-    bindingLayout.buffer.minBindingSize = sizeof(Uniforms);
+    pipeline = device.CreateRenderPipeline(&pipelineDesc);
+    bundlesDirty = true;
+    return true;
+}
 
-    wgpu::BindGroupLayoutDescriptor bindGroupLayoutDesc = {};
-    bindGroupLayoutDesc.entryCount = 1;
-    bindGroupLayoutDesc.entries = &bindingLayout;
-    bindGroupLayout = device.CreateBindGroupLayout(&bindGroupLayoutDesc);
+wgpu::Buffer Renderer::CreateVertexBuffer(const void* data, size_t size, wgpu::BufferUsage extraUsage) {
+    if (size > maxBufferSize) {
+        std::cerr << "Vertex stream of " << size << " bytes exceeds the device buffer limit of "
+                  << maxBufferSize << " bytes" << std::endl;
+        return wgpu::Buffer();
+    }
+    wgpu::BufferDescriptor bufferDesc = {};
+    bufferDesc.size = size;
+    bufferDesc.usage = wgpu::BufferUsage::Vertex | wgpu::BufferUsage::CopyDst | extraUsage;
+    wgpu::Buffer buffer = device.CreateBuffer(&bufferDesc);
+    queue.WriteBuffer(buffer, 0, data, size);
+    return buffer;
+}
 
-    wgpu::PipelineLayoutDescriptor pipelineLayoutDesc = {};
-    pipelineLayoutDesc.bindGroupLayoutCount = 1;
-    pipelineLayoutDesc.bindGroupLayouts = &bindGroupLayout;
-    wgpu::PipelineLayout pipelineLayout = device.CreatePipelineLayout(&pipelineLayoutDesc);
-    pipelineDesc.layout = pipelineLayout;
+bool Renderer::SetPointCloud(PointCloud cloud) {
+    vertexCount = static_cast<uint32_t>(cloud.Size());
 
-    wgpu::BindGroupEntry binding = {};
-    binding.binding = 0;
-    binding.buffer = uniformBuffer;
-    binding.offset = 0;
-    binding.size = sizeof(Uniforms);
+    // Center and scale to fit within [-0.9, 0.9]
+    NormalizePositions(cloud.positions, 0.9f);
+    positionBuffer = CreateVertexBuffer(cloud.positions.data(), cloud.positions.size() * sizeof(Float3));
+    if (!positionBuffer) return false;
+
+    // Positions are resident now; keep the other columns on the CPU so that
+    // only the attribute being displayed is uploaded.
+    cloud.positions = {};
+    pointCloud = std::move(cloud);
+
+    // Split the resident buffer into fixed-size chunks; each chunk is one draw.
+    chunks.clear();
+    for (uint32_t first = 0; first < vertexCount; first += kChunkSize) {
+        chunks.push_back({first, std::min(kChunkSize, vertexCount - first)});
+    }
 
-    wgpu::BindGroupDescriptor bindGroupDesc = {};
-    bindGroupDesc.layout = bindGroupLayout;
-    bindGroupDesc.entryCount = 1;
-    bindGroupDesc.entries = &binding;
-    bindGroup = device.CreateBindGroup(&bindGroupDesc);
+    std::string defaultAttribute;
+    if (const ScalarField* intensity = pointCloud.Intensity()) defaultAttribute = intensity->name;
+    else if (pointCloud.HasColors()) defaultAttribute = "rgb";
+    else if (!pointCloud.scalarFields.empty()) defaultAttribute = pointCloud.scalarFields[0].name;
+    else if (pointCloud.HasNormals()) defaultAttribute = "normal";
+    colorAttribute.clear();
+    return SetColorAttribute(defaultAttribute);
+}
 
-    pipeline = device.CreateRenderPipeline(&pipelineDesc);
+bool Renderer::SetColorAttribute(const std::string& name) {
+    if (!colorAttribute.empty() && name == colorAttribute) return true;
+
+    ColorMode mode = ColorMode::None;
+    const void* data = nullptr;
+    size_t size = 0;
+    if (name.empty()) {
+        mode = ColorMode::None;
+    } else if (name == "rgb" && pointCloud.HasColors()) {
+        mode = ColorMode::Rgb;
+        data = pointCloud.colors.data();
+        size = pointCloud.colors.size() * sizeof(uint32_t);
+    } else if (name == "normal" && pointCloud.HasNormals()) {
+        mode = ColorMode::Normal;
+        data = pointCloud.normals.data();
+        size = pointCloud.normals.size() * sizeof(Float3);
+    } else if (const ScalarField* field = pointCloud.FindScalarField(name)) {
+        mode = ColorMode::Scalar;
+        data = field->values.data();
+        size = field->values.size() * sizeof(float);
+    } else {
+        std::cerr << "Unknown color attribute: " << name << std::endl;
+        return false;
+    }
+
+    // Replacing the buffer releases the previously displayed stream. Scalar
+    // streams are also read by the reduction passes that drive the colormap.
+    wgpu::Buffer buffer;
+    if (data) {
+        wgpu::BufferUsage extraUsage = mode == ColorMode::Scalar ? wgpu::BufferUsage::Storage : wgpu::BufferUsage::None;
+        buffer = CreateVertexBuffer(data, size, extraUsage);
+        if (!buffer) return false;
+    }
+    colorBuffer = buffer;
+    if (mode == ColorMode::Scalar) {
+        scalarReduction.SetSource(colorBuffer, size / sizeof(float));
+    }
+    colorAttribute = name;
+    if (mode != colorMode || !pipeline) {
+        colorMode = mode;
+        CreateRenderPipeline();
+    }
+    bundlesDirty = true;
     return true;
 }
 
-void Renderer::SetVertices(const std::vector<Vertex>& vertices) {
-    vertexCount = static_cast<uint32_t>(vertices.size());
-
-    // Compute bounding box
-    float minX = FLT_MAX, maxX = -FLT_MAX;
-    float minY = FLT_MAX, maxY = -FLT_MAX;
-    float minZ = FLT_MAX, maxZ = -FLT_MAX;
-    for (const auto& v : vertices) {
-        minX = std::min(minX, v.x); maxX = std::max(maxX, v.x);
-        minY = std::min(minY, v.y); maxY = std::max(maxY, v.y);
-        minZ = std::min(minZ, v.z); maxZ = std::max(maxZ, v.z);
+wgpu::RenderBundle Renderer::RecordBundle(size_t firstChunk, size_t chunkCount) const {
+    wgpu::RenderBundleEncoderDescriptor bundleDesc = {};
+    bundleDesc.colorFormatCount = 1;
+    bundleDesc.colorFormats = &format;
+    bundleDesc.sampleCount = 1;
+
+    wgpu::RenderBundleEncoder bundleEncoder = device.CreateRenderBundleEncoder(&bundleDesc);
+    bundleEncoder.SetPipeline(pipeline);
+    bundleEncoder.SetBindGroup(0, bindGroup);
+    bundleEncoder.SetVertexBuffer(0, positionBuffer);
+    if (colorBuffer) {
+        bundleEncoder.SetVertexBuffer(1, colorBuffer);
     }
+    for (size_t i = firstChunk; i < firstChunk + chunkCount; ++i) {
+        bundleEncoder.Draw(chunks[i].vertexCount, 1, chunks[i].firstVertex, 0);
+    }
+    return bundleEncoder.Finish();
+}
 
-    // Center and scale to fit within [-0.9, 0.9]
-    float centerX = (minX + maxX) / 2.0f;
-    float centerY = (minY + maxY) / 2.0f;
-    float centerZ = (minZ + maxZ) / 2.0f;
-    float maxExtent = std::max({maxX - minX, maxY - minY, maxZ - minZ});
-    float scale = 1.8f / maxExtent;
-
-    std::vector<Vertex> normalized(vertices.size());
-    for (size_t i = 0; i < vertices.size(); ++i) {
-        normalized[i].x = (vertices[i].x - centerX) * scale;
-        normalized[i].y = (vertices[i].y - centerY) * scale;
-        normalized[i].z = (vertices[i].z - centerZ) * scale;
-        normalized[i].intensity = vertices[i].intensity;
+void Renderer::RecordBundles() {
+    size_t bundleCount = (chunks.size() + kChunksPerBundle - 1) / kChunksPerBundle;
+    bundles.assign(bundleCount, nullptr);
+
+    auto recordRange = [this](size_t firstBundle, size_t lastBundle) {
+        for (size_t b = firstBundle; b < lastBundle; ++b) {
+            size_t firstChunk = b * kChunksPerBundle;
+            size_t chunkCount = std::min(kChunksPerBundle, chunks.size() - firstChunk);
+            bundles[b] = RecordBundle(firstChunk, chunkCount);
+        }
+    };
+
+    // Without implicit device synchronization the device must only be used
+    // from one thread, so fall back to recording everything here.
+    size_t workerCount = 1;
+    if (multithreadedEncoding && bundleCount > 1) {
+        workerCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, bundleCount);
     }
 
-    wgpu::BufferDescriptor bufferDesc = {};
-    bufferDesc.size = normalized.size() * sizeof(Vertex);
-    bufferDesc.usage = wgpu::BufferUsage::Vertex | wgpu::BufferUsage::CopyDst;
-    vertexBuffer = device.CreateBuffer(&bufferDesc);
-    queue.WriteBuffer(vertexBuffer, 0, normalized.data(), bufferDesc.size);
+    if (workerCount <= 1) {
+        recordRange(0, bundleCount);
+    } else {
+        // Each worker records a disjoint range of bundles into its own slots.
+        std::vector<std::thread> workers;
+        size_t perWorker = (bundleCount + workerCount - 1) / workerCount;
+        for (size_t first = 0; first < bundleCount; first += perWorker) {
+            workers.emplace_back(recordRange, first, std::min(first + perWorker, bundleCount));
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    bundlesDirty = false;
 }
 
-void Renderer::Render() {
-    wgpu::SurfaceTexture surfaceTexture;
-    surface.GetCurrentTexture(&surfaceTexture);
-    if (!surfaceTexture.texture) return;
-    
+void Renderer::EncodeScene(const wgpu::CommandEncoder& encoder, const wgpu::TextureView& target) {
     wgpu::RenderPassColorAttachment colorAttachment = {};
-    colorAttachment.view = surfaceTexture.texture.CreateView();
+    colorAttachment.view = target;
     colorAttachment.loadOp = wgpu::LoadOp::Clear;
     colorAttachment.storeOp = wgpu::StoreOp::Store;
     colorAttachment.clearValue = {0.1f, 0.1f, 0.2f, 1.0f};
@@ -335,17 +520,70 @@ void Renderer::Render() {
     renderPassDesc.colorAttachmentCount = 1;
     renderPassDesc.colorAttachments = &colorAttachment;
 
-    wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+    // Bundles only reference the uniform buffer, so camera changes do not
+    // require re-recording; only residency or pipeline changes do.
+    if (bundlesDirty) {
+        RecordBundles();
+    }
+
+    // Recomputes the colormap range only after the scalar stream changed
+    scalarReduction.Encode(encoder);
+
     wgpu::RenderPassEncoder pass = encoder.BeginRenderPass(&renderPassDesc);
-    pass.SetPipeline(pipeline);
-    pass.SetBindGroup(0, bindGroup);
-    pass.SetVertexBuffer(0, vertexBuffer);
-    pass.Draw(vertexCount);
+    if (!bundles.empty()) {
+        pass.ExecuteBundles(bundles.size(), bundles.data());
+    }
     pass.End();
+}
+
+void Renderer::Render() {
+    wgpu::SurfaceTexture surfaceTexture;
+    surface.GetCurrentTexture(&surfaceTexture);
+    if (!surfaceTexture.texture) return;
+
+    wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+    EncodeScene(encoder, surfaceTexture.texture.CreateView());
 
     wgpu::CommandBuffer commands = encoder.Finish();
     queue.Submit(1, &commands);
+    scalarReduction.OnSubmitted();
     surface.Present();
+    scalarReduction.Poll();
+}
+
+bool Renderer::BeginCapture(const std::string& outputDir, CaptureFormat captureFormat, size_t workerCount) {
+    wgpu::TextureDescriptor textureDesc = {};
+    textureDesc.size = {width, height, 1};
+    textureDesc.format = format;
+    textureDesc.usage = wgpu::TextureUsage::RenderAttachment | wgpu::TextureUsage::CopySrc;
+    captureTexture = device.CreateTexture(&textureDesc);
+
+    frameCapture = std::make_unique<FrameCapture>();
+    return frameCapture->Initialize(device, width, height, outputDir, captureFormat, workerCount);
+}
+
+void Renderer::CaptureFrame() {
+    wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
+    EncodeScene(encoder, captureTexture.CreateView());
+    frameCapture->EncodeCopy(encoder, captureTexture);
+
+    wgpu::CommandBuffer commands = encoder.Finish();
+    queue.Submit(1, &commands);
+    scalarReduction.OnSubmitted();
+    frameCapture->OnSubmitted();
+}
+
+bool Renderer::EndCapture(uint64_t& outFramesWritten) {
+    bool ok = frameCapture->Finish();
+    outFramesWritten = frameCapture->FramesWritten();
+    frameCapture.reset();
+    captureTexture = wgpu::Texture();
+    return ok;
+}
+
+void Renderer::SetOrbitAngle(float angle) {
+    rotationY = angle;
+    UpdateUniforms();
 }
 
 void Renderer::Zoom(float delta) {
@@ -356,7 +594,7 @@ void Renderer::Zoom(float delta) {
 }
 
 void Renderer::UpdateUniforms() {
-    float aspect = 800.0f / 600.0f;
+    float aspect = static_cast<float>(width) / static_cast<float>(height);
     if (window) {
         int w, h;
         glfwGetWindowSize(window, &w, &h);
@@ -460,12 +698,12 @@ void Renderer::OnCursorPos(double x, double y) {
             UpdateUniforms();
         } else if (isDraggingRight) {
             // Panning
-            int width = 800, height = 600;
+            int windowWidth = static_cast<int>(width), windowHeight = static_cast<int>(height);
             if (window) {
-                glfwGetWindowSize(window, &width, &height);
+                glfwGetWindowSize(window, &windowWidth, &windowHeight);
             }
-            float ndcDeltaX = deltaX * (2.0f / width);
-            float ndcDeltaY = deltaY * (-2.0f / height); 
+            float ndcDeltaX = deltaX * (2.0f / windowWidth);
+            float ndcDeltaY = deltaY * (-2.0f / windowHeight); 
             Pan(ndcDeltaX, ndcDeltaY);
         }
     }
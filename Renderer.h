@@ -2,7 +2,11 @@
 
 #include <webgpu/webgpu_cpp.h>
 #include <vector>
-#include "PlyLoader.h"
+#include <string>
+#include <memory>
+#include "PointCloud.h"
+#include "ScalarReduction.h"
+#include "FrameCapture.h"
 
 struct GLFWwindow;
 
@@ -16,30 +20,89 @@ public:
     Renderer();
     ~Renderer();
 
-    bool Initialize(GLFWwindow* window, const std::string& preferredDevice = "");
-    void SetVertices(const std::vector<Vertex>& vertices);
+    // Pass a null window to run headless (capture only).
+    bool Initialize(GLFWwindow* window, const std::string& preferredDevice = "",
+                    uint32_t width = 800, uint32_t height = 600);
+    // Fails if a vertex stream exceeds the device's maxBufferSize.
+    bool SetPointCloud(PointCloud cloud);
+    // Colors points by "rgb", "normal" or a scalar field name. Only that
+    // attribute's stream is uploaded; the previous one is released.
+    bool SetColorAttribute(const std::string& name);
     void Render();
+
+    // Offscreen capture: each CaptureFrame renders and queues a readback
+    // without waiting for the GPU; EndCapture drains the pipeline.
+    bool BeginCapture(const std::string& outputDir, CaptureFormat captureFormat, size_t workerCount);
+    void CaptureFrame();
+    bool EndCapture(uint64_t& outFramesWritten);
+
+    // Orbits the camera around the vertical axis (turntable)
+    void SetOrbitAngle(float angle);
     void Zoom(float delta);
     void Pan(float dx, float dy);
     void OnMouseButton(int button, int action, int mods);
     void OnCursorPos(double x, double y);
 
 private:
+    // Points per draw call, and draw calls per pre-recorded render bundle.
+    static constexpr uint32_t kChunkSize = 65536;
+    static constexpr size_t kChunksPerBundle = 64;
+    static constexpr uint32_t kColormapSize = 256;
+
+    enum class ColorMode { None, Scalar, Rgb, Normal };
+
+    struct Chunk {
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+    };
+
     void UpdateUniforms();
+    void InitColormap();
+    bool CreateRenderPipeline();
+    wgpu::Buffer CreateVertexBuffer(const void* data, size_t size,
+                                    wgpu::BufferUsage extraUsage = wgpu::BufferUsage::None);
+    void EncodeScene(const wgpu::CommandEncoder& encoder, const wgpu::TextureView& target);
+    void RecordBundles();
+    wgpu::RenderBundle RecordBundle(size_t firstChunk, size_t chunkCount) const;
 
     wgpu::Instance instance;
     wgpu::Device device;
     wgpu::Queue queue;
     wgpu::Surface surface;
+    wgpu::ShaderModule shaderModule;
+    wgpu::PipelineLayout pipelineLayout;
     wgpu::RenderPipeline pipeline;
-    wgpu::Buffer vertexBuffer;
     uint32_t vertexCount = 0;
+
+    // Per-attribute vertex streams; only the active color stream is resident
+    PointCloud pointCloud;
+    wgpu::Buffer positionBuffer;
+    wgpu::Buffer colorBuffer;
+    std::string colorAttribute;
+    ColorMode colorMode = ColorMode::None;
+
+    // Scalar streams are colored through a colormap over a GPU-computed range
+    ScalarReduction scalarReduction;
+    wgpu::Texture colormapTexture;
+    wgpu::Sampler colormapSampler;
     wgpu::TextureFormat format = wgpu::TextureFormat::BGRA8Unorm;
+    uint32_t width = 800;
+    uint32_t height = 600;
+
+    wgpu::Texture captureTexture;
+    std::unique_ptr<FrameCapture> frameCapture;
 
     wgpu::Buffer uniformBuffer;
     wgpu::BindGroup bindGroup;
     wgpu::BindGroupLayout bindGroupLayout;
 
+    // Render bundles for static chunk sets, re-recorded when dirty
+    std::vector<Chunk> chunks;
+    std::vector<wgpu::RenderBundle> bundles;
+    bool bundlesDirty = true;
+    bool multithreadedEncoding = false;
+    uint64_t maxBufferSize = 0;
+
     // Camera State
     float zoomLevel = 1.0f;
     float translationX = 0.0f;
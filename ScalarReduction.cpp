@@ -0,0 +1,307 @@
+#include "ScalarReduction.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr uint32_t kBinCount = 256;
+    // Values each invocation processes on average before the grid-stride loop wraps
+    constexpr uint32_t kValuesPerInvocation = 16;
+    constexpr uint32_t kWorkgroupSize = 256;
+    // minKey, maxKey, count, padding, then the histogram
+    constexpr uint64_t kStatsSize = sizeof(uint32_t) * (4 + kBinCount);
+    // Upper bound on values per binding so that u32 indices in the shader cannot overflow
+    constexpr uint64_t kMaxSegmentSize = 1ull << 30;
+}
+
+static const char* reductionShaderCode = R"(
+struct Stats {
+    minKey: atomic<u32>, // stored inverted so that a zero-cleared buffer is the identity
+    maxKey: atomic<u32>,
+    count: atomic<u32>,
+    padding: u32,
+    histogram: array<atomic<u32>, 256>,
+};
+
+struct ScalarRange {
+    minValue: f32,
+    maxValue: f32,
+    low: f32,
+    high: f32,
+};
+
+override lowPercentile: f32 = 0.02;
+override highPercentile: f32 = 0.98;
+
+@group(0) @binding(0) var<storage, read> values: array<f32>;
+@group(0) @binding(1) var<storage, read_write> stats: Stats;
+@group(0) @binding(2) var<storage, read_write> result: ScalarRange;
+
+var<workgroup> localMinKey: atomic<u32>;
+var<workgroup> localMaxKey: atomic<u32>;
+var<workgroup> localCount: atomic<u32>;
+var<workgroup> localHistogram: array<atomic<u32>, 256>;
+
+// Order-preserving mapping between f32 and u32
+fn floatToKey(v: f32) -> u32 {
+    let bits = bitcast<u32>(v);
+    return select(bits | 0x80000000u, ~bits, (bits & 0x80000000u) != 0u);
+}
+
+fn keyToFloat(k: u32) -> f32 {
+    return select(bitcast<f32>(~k), bitcast<f32>(k & 0x7fffffffu), (k & 0x80000000u) != 0u);
+}
+
+// Invalid returns are often stored as NaN; those and infinities are left out
+// of the range. Tested on the bits, since NaN comparisons may be folded away.
+fn isFinite(v: f32) -> bool {
+    return (bitcast<u32>(v) & 0x7f800000u) != 0x7f800000u;
+}
+
+fn loadMin() -> f32 { return keyToFloat(~atomicLoad(&stats.minKey)); }
+fn loadMax() -> f32 { return keyToFloat(atomicLoad(&stats.maxKey)); }
+
+@compute @workgroup_size(256)
+fn reduce_minmax(@builtin(local_invocation_index) lid: u32,
+                 @builtin(global_invocation_id) gid: vec3<u32>,
+                 @builtin(num_workgroups) groups: vec3<u32>) {
+    let n = arrayLength(&values);
+    let stride = groups.x * 256u;
+    var minKey = 0u;
+    var maxKey = 0u;
+    var count = 0u;
+    for (var i = gid.x; i < n; i += stride) {
+        let v = values[i];
+        if (!isFinite(v)) {
+            continue;
+        }
+        let key = floatToKey(v);
+        minKey = max(minKey, ~key);
+        maxKey = max(maxKey, key);
+        count += 1u;
+    }
+    atomicMax(&localMinKey, minKey);
+    atomicMax(&localMaxKey, maxKey);
+    atomicAdd(&localCount, count);
+    workgroupBarrier();
+    if (lid == 0u) {
+        atomicMax(&stats.minKey, atomicLoad(&localMinKey));
+        atomicMax(&stats.maxKey, atomicLoad(&localMaxKey));
+        atomicAdd(&stats.count, atomicLoad(&localCount));
+    }
+}
+
+@compute @workgroup_size(256)
+fn reduce_histogram(@builtin(local_invocation_index) lid: u32,
+                    @builtin(global_invocation_id) gid: vec3<u32>,
+                    @builtin(num_workgroups) groups: vec3<u32>) {
+    let lo = loadMin();
+    let hi = loadMax();
+    let scale = select(0.0, 256.0 / (hi - lo), hi > lo);
+    let n = arrayLength(&values);
+    let stride = groups.x * 256u;
+    for (var i = gid.x; i < n; i += stride) {
+        let v = values[i];
+        if (!isFinite(v)) {
+            continue;
+        }
+        let bin = min(u32((v - lo) * scale), 255u);
+        atomicAdd(&localHistogram[bin], 1u);
+    }
+    workgroupBarrier();
+    let binCount = atomicLoad(&localHistogram[lid]);
+    if (binCount != 0u) {
+        atomicAdd(&stats.histogram[lid], binCount);
+    }
+}
+
+@compute @workgroup_size(1)
+fn reduce_percentiles() {
+    let lo = loadMin();
+    let hi = loadMax();
+    let total = f32(atomicLoad(&stats.count));
+    let binWidth = (hi - lo) / 256.0;
+    let lowTarget = lowPercentile * total;
+    let highTarget = highPercentile * total;
+
+    var low = lo;
+    var high = hi;
+    var foundLow = false;
+    var foundHigh = false;
+    var cumulative = 0.0;
+    for (var b = 0u; b < 256u; b++) {
+        let binCount = f32(atomicLoad(&stats.histogram[b]));
+        let next = cumulative + binCount;
+        // Interpolate linearly within the bin that crosses the target
+        if (!foundLow && next >= lowTarget) {
+            low = lo + (f32(b) + (lowTarget - cumulative) / max(binCount, 1.0)) * binWidth;
+            foundLow = true;
+        }
+        if (!foundHigh && next >= highTarget) {
+            high = lo + (f32(b) + (highTarget - cumulative) / max(binCount, 1.0)) * binWidth;
+            foundHigh = true;
+        }
+        cumulative = next;
+    }
+
+    result.minValue = lo;
+    result.maxValue = hi;
+    result.low = low;
+    result.high = high;
+}
+)";
+
+bool ScalarReduction::Initialize(const wgpu::Device& device, float lowPercentile, float highPercentile) {
+    this->device = device;
+
+    // Segment offsets must stay multiples of the storage offset alignment.
+    wgpu::Limits limits = {};
+    device.GetLimits(&limits);
+    uint64_t alignment = limits.minStorageBufferOffsetAlignment;
+    uint64_t bindingSize = limits.maxStorageBufferBindingSize / alignment * alignment;
+    segmentSize = std::min(bindingSize / sizeof(float), kMaxSegmentSize);
+
+    wgpu::ShaderModuleDescriptor shaderDesc = {};
+    wgpu::ShaderSourceWGSL wgslDesc = {};
+    wgslDesc.code = reductionShaderCode;
+    shaderDesc.nextInChain = &wgslDesc;
+    wgpu::ShaderModule shaderModule = device.CreateShaderModule(&shaderDesc);
+
+    wgpu::BindGroupLayoutEntry entries[3] = {};
+    for (uint32_t i = 0; i < 3; ++i) {
+        entries[i].binding = i;
+        entries[i].visibility = wgpu::ShaderStage::Compute;
+        entries[i].buffer.type = wgpu::BufferBindingType::Storage;
+    }
+    entries[0].buffer.type = wgpu::BufferBindingType::ReadOnlyStorage;
+
+    wgpu::BindGroupLayoutDescriptor bindGroupLayoutDesc = {};
+    bindGroupLayoutDesc.entryCount = 3;
+    bindGroupLayoutDesc.entries = entries;
+    bindGroupLayout = device.CreateBindGroupLayout(&bindGroupLayoutDesc);
+
+    wgpu::PipelineLayoutDescriptor pipelineLayoutDesc = {};
+    pipelineLayoutDesc.bindGroupLayoutCount = 1;
+    pipelineLayoutDesc.bindGroupLayouts = &bindGroupLayout;
+    wgpu::PipelineLayout pipelineLayout = device.CreatePipelineLayout(&pipelineLayoutDesc);
+
+    wgpu::ConstantEntry constants[2] = {};
+    constants[0].key = "lowPercentile";
+    constants[0].value = lowPercentile;
+    constants[1].key = "highPercentile";
+    constants[1].value = highPercentile;
+
+    auto createPipeline = [&](const char* entryPoint) {
+        wgpu::ComputePipelineDescriptor pipelineDesc = {};
+        pipelineDesc.layout = pipelineLayout;
+        pipelineDesc.compute.module = shaderModule;
+        pipelineDesc.compute.entryPoint = entryPoint;
+        pipelineDesc.compute.constantCount = 2;
+        pipelineDesc.compute.constants = constants;
+        return device.CreateComputePipeline(&pipelineDesc);
+    };
+    minMaxPipeline = createPipeline("reduce_minmax");
+    histogramPipeline = createPipeline("reduce_histogram");
+    percentilePipeline = createPipeline("reduce_percentiles");
+
+    wgpu::BufferDescriptor bufferDesc = {};
+    bufferDesc.size = kStatsSize;
+    bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
+    statsBuffer = device.CreateBuffer(&bufferDesc);
+
+    bufferDesc.size = sizeof(ScalarRange);
+    bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopySrc | wgpu::BufferUsage::CopyDst;
+    rangeBuffer = device.CreateBuffer(&bufferDesc);
+
+    bufferDesc.usage = wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst;
+    readbackBuffer = device.CreateBuffer(&bufferDesc);
+
+    // Until the first reduction runs, map [0, 255] like the old fixed scaling.
+    ScalarRange initial = {0.0f, 255.0f, 0.0f, 255.0f};
+    device.GetQueue().WriteBuffer(rangeBuffer, 0, &initial, sizeof(initial));
+    return true;
+}
+
+void ScalarReduction::SetSource(const wgpu::Buffer& values, uint64_t count) {
+    segments.clear();
+    for (uint64_t first = 0; first < count; first += segmentSize) {
+        uint64_t segmentCount = std::min(segmentSize, count - first);
+
+        wgpu::BindGroupEntry entries[3] = {};
+        entries[0].binding = 0;
+        entries[0].buffer = values;
+        entries[0].offset = first * sizeof(float);
+        entries[0].size = segmentCount * sizeof(float);
+        entries[1].binding = 1;
+        entries[1].buffer = statsBuffer;
+        entries[1].size = kStatsSize;
+        entries[2].binding = 2;
+        entries[2].buffer = rangeBuffer;
+        entries[2].size = sizeof(ScalarRange);
+
+        wgpu::BindGroupDescriptor bindGroupDesc = {};
+        bindGroupDesc.layout = bindGroupLayout;
+        bindGroupDesc.entryCount = 3;
+        bindGroupDesc.entries = entries;
+
+        uint64_t invocations = (segmentCount + kValuesPerInvocation - 1) / kValuesPerInvocation;
+        uint64_t workgroups = (invocations + kWorkgroupSize - 1) / kWorkgroupSize;
+        segments.push_back({device.CreateBindGroup(&bindGroupDesc),
+                            static_cast<uint32_t>(std::clamp<uint64_t>(workgroups, 1, 65535))});
+    }
+    dirty = !segments.empty();
+}
+
+void ScalarReduction::Encode(const wgpu::CommandEncoder& encoder) {
+    if (!dirty) return;
+
+    encoder.ClearBuffer(statsBuffer, 0, kStatsSize);
+
+    // Passes are separate dispatches so each sees the previous one's results.
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass();
+    pass.SetPipeline(minMaxPipeline);
+    for (const auto& segment : segments) {
+        pass.SetBindGroup(0, segment.bindGroup);
+        pass.DispatchWorkgroups(segment.workgroupCount);
+    }
+    pass.SetPipeline(histogramPipeline);
+    for (const auto& segment : segments) {
+        pass.SetBindGroup(0, segment.bindGroup);
+        pass.DispatchWorkgroups(segment.workgroupCount);
+    }
+    pass.SetPipeline(percentilePipeline);
+    pass.SetBindGroup(0, segments[0].bindGroup);
+    pass.DispatchWorkgroups(1);
+    pass.End();
+
+    // The readback buffer cannot be a copy destination while it is mapped.
+    copyEncoded = !readbackPending;
+    if (copyEncoded) {
+        encoder.CopyBufferToBuffer(rangeBuffer, 0, readbackBuffer, 0, sizeof(ScalarRange));
+    }
+    dirty = false;
+}
+
+void ScalarReduction::OnSubmitted() {
+    if (!copyEncoded) return;
+    copyEncoded = false;
+    readbackPending = true;
+
+    readbackBuffer.MapAsync(wgpu::MapMode::Read, 0, sizeof(ScalarRange), wgpu::CallbackMode::AllowSpontaneous,
+        [this](wgpu::MapAsyncStatus status, wgpu::StringView) {
+            if (status == wgpu::MapAsyncStatus::Success) {
+                ScalarRange range;
+                std::memcpy(&range, readbackBuffer.GetConstMappedRange(0, sizeof(ScalarRange)), sizeof(ScalarRange));
+                readbackBuffer.Unmap();
+                std::cout << "Scalar range: min " << range.minValue << ", max " << range.maxValue
+                          << ", color range [" << range.low << ", " << range.high << "]" << std::endl;
+            }
+            readbackPending = false;
+        });
+}
+
+void ScalarReduction::Poll() {
+    if (readbackPending) {
+        device.Tick();
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+#include <vector>
+#include <atomic>
+
+// Layout of the result buffer; also read by the render shader.
+struct ScalarRange {
+    float minValue;
+    float maxValue;
+    float low;  // lowPercentile of the values
+    float high; // highPercentile of the values
+};
+
+// GPU reduction of one scalar vertex stream into min/max, a 256-bin
+// histogram and low/high percentiles. Only runs when the source changes, and
+// only the 16-byte ScalarRange is read back.
+class ScalarReduction {
+public:
+    bool Initialize(const wgpu::Device& device, float lowPercentile = 0.02f, float highPercentile = 0.98f);
+
+    // values must have Storage usage. Marks the result dirty.
+    void SetSource(const wgpu::Buffer& values, uint64_t count);
+
+    // Records the reduction passes and, if no readback is in flight, a copy
+    // of the result into the readback buffer.
+    void Encode(const wgpu::CommandEncoder& encoder);
+
+    // Maps the copied result once the encoded commands have been submitted.
+    void OnSubmitted();
+
+    // Lets the device complete an in-flight readback.
+    void Poll();
+
+    const wgpu::Buffer& RangeBuffer() const { return rangeBuffer; }
+
+private:
+    struct Segment {
+        wgpu::BindGroup bindGroup;
+        uint32_t workgroupCount;
+    };
+
+    wgpu::Device device;
+    wgpu::BindGroupLayout bindGroupLayout;
+    wgpu::ComputePipeline minMaxPipeline;
+    wgpu::ComputePipeline histogramPipeline;
+    wgpu::ComputePipeline percentilePipeline;
+    wgpu::Buffer statsBuffer;
+    wgpu::Buffer rangeBuffer;
+    wgpu::Buffer readbackBuffer;
+    // Values per storage binding, from the device's maxStorageBufferBindingSize
+    uint64_t segmentSize = 0;
+    std::vector<Segment> segments;
+    bool dirty = false;
+    bool copyEncoded = false;
+    std::atomic<bool> readbackPending = false;
+};
@@ -1,6 +1,9 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
 #include "PlyLoader.h"
 #include "Renderer.h"
 
@@ -25,42 +28,122 @@ void cursor_position_callback(GLFWwindow* window, double xpos, double ypos) {
     }
 }
 
+void PrintUsage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " <ply_file> [--device <device_name_substring|cpu>] [--color <rgb|normal|scalar_field>]\n"
+              << "       [--capture <dir> [--frames <n>] [--capture-format <png|raw>] [--size <WxH>]]" << std::endl;
+}
+
+// Parses a positive decimal number; rejects trailing junk instead of throwing.
+bool ParsePositive(const std::string& text, uint32_t& outValue) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos || text.size() > 9) return false;
+    outValue = static_cast<uint32_t>(std::stoul(text));
+    return outValue > 0;
+}
+
+// Parses "WxH" with both sides positive.
+bool ParseSize(const std::string& text, uint32_t& outWidth, uint32_t& outHeight) {
+    size_t x = text.find('x');
+    return x != std::string::npos && ParsePositive(text.substr(0, x), outWidth) &&
+           ParsePositive(text.substr(x + 1), outHeight);
+}
+
+// Renders a full turntable orbit offscreen and writes every frame to outputDir.
+int RunCapture(Renderer& renderer, const std::string& outputDir, CaptureFormat format, uint32_t frameCount) {
+    // Leave one core for the render loop
+    size_t workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    if (!renderer.BeginCapture(outputDir, format, workerCount)) {
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < frameCount; ++i) {
+        renderer.SetOrbitAngle(2.0f * 3.14159265f * static_cast<float>(i) / static_cast<float>(frameCount));
+        renderer.CaptureFrame();
+    }
+    uint64_t framesWritten = 0;
+    bool ok = renderer.EndCapture(framesWritten);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Wrote " << framesWritten << " frames to " << outputDir << " in " << seconds << " s ("
+              << framesWritten / std::max(seconds, 1e-9) << " frames/sec)" << std::endl;
+    return ok ? 0 : 1;
+}
+
 int main(int argc, char** argv) {
     std::string filename;
     std::string preferredDevice;
+    std::string colorAttribute;
+    std::string captureDir;
+    CaptureFormat captureFormat = CaptureFormat::Png;
+    uint32_t frameCount = 120;
+    uint32_t width = 800, height = 600;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--device" && i + 1 < argc) {
             preferredDevice = argv[++i];
-        } else if (filename.empty()) {
+        } else if (arg == "--color" && i + 1 < argc) {
+            colorAttribute = argv[++i];
+        } else if (arg == "--capture" && i + 1 < argc) {
+            captureDir = argv[++i];
+        } else if (arg == "--frames" && i + 1 < argc && ParsePositive(argv[i + 1], frameCount)) {
+            ++i;
+        } else if (arg == "--capture-format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format != "png" && format != "raw") {
+                std::cerr << "Unknown capture format: " << format << std::endl;
+                return 1;
+            }
+            captureFormat = format == "raw" ? CaptureFormat::Raw : CaptureFormat::Png;
+        } else if (arg == "--size" && i + 1 < argc && ParseSize(argv[i + 1], width, height)) {
+            ++i;
+        } else if (arg.rfind("--", 0) != 0 && filename.empty()) {
             filename = arg;
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            PrintUsage(argv[0]);
+            return 1;
         }
     }
 
     if (filename.empty()) {
-        std::cerr << "Usage: " << argv[0] << " <ply_file> [--device <device_name_substring>]" << std::endl;
+        PrintUsage(argv[0]);
         return 1;
     }
-    std::vector<Vertex> vertices;
-    if (!PlyLoader::Load(filename, vertices)) {
+    PointCloud cloud;
+    if (!PlyLoader::Load(filename, cloud)) {
         return 1;
     }
-    std::cout << "Successfully loaded " << vertices.size() << " vertices from " << filename << std::endl;
+    std::cout << "Successfully loaded " << cloud.Size() << " vertices from " << filename << std::endl;
+
+    // Capture runs headless: no window, no surface.
+    if (!captureDir.empty()) {
+        Renderer renderer;
+        if (!renderer.Initialize(nullptr, preferredDevice, width, height)) {
+            return 1;
+        }
+        if (!renderer.SetPointCloud(std::move(cloud))) {
+            return 1;
+        }
+        if (!colorAttribute.empty() && !renderer.SetColorAttribute(colorAttribute)) {
+            return 1;
+        }
+        return RunCapture(renderer, captureDir, captureFormat, frameCount);
+    }
 
     if (!glfwInit()) {
         return 1;
     }
 
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    GLFWwindow* window = glfwCreateWindow(800, 600, "Dawn PLY Viewer", nullptr, nullptr);
+    GLFWwindow* window = glfwCreateWindow(width, height, "Dawn PLY Viewer", nullptr, nullptr);
     if (!window) {
         glfwTerminate();
         return 1;
     }
 
     Renderer renderer;
-    if (!renderer.Initialize(window, preferredDevice)) {
+    if (!renderer.Initialize(window, preferredDevice, width, height)) {
         return 1;
     }
 
@@ -69,7 +152,12 @@ int main(int argc, char** argv) {
     glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSetCursorPosCallback(window, cursor_position_callback);
 
-    renderer.SetVertices(vertices);
+    if (!renderer.SetPointCloud(std::move(cloud))) {
+        return 1;
+    }
+    if (!colorAttribute.empty() && !renderer.SetColorAttribute(colorAttribute)) {
+        return 1;
+    }
 
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
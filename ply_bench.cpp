@@ -0,0 +1,411 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <memory>
+#include "PlyLoader.h"
+#include "PlyWriter.h"
+#include "PointOps.h"
+#include "Mat4.h"
+
+namespace {
+    constexpr size_t kDefaultRepetitions = 10;
+    // Identical runs of the small bundled clouds differ by up to ~30% on busy
+    // machines, so a tighter threshold needs a quiet machine.
+    constexpr double kDefaultThreshold = 0.3;
+    // Each sample repeats the operation for at least this long, so that
+    // sub-millisecond passes are not dominated by timer and scheduling noise.
+    constexpr double kMinSampleSeconds = 0.05;
+    constexpr uint64_t kMat4Iterations = 1000000;
+    constexpr size_t kWriteChunkSize = 1 << 20;
+
+    // Keeps benchmarked results observable so the work is not optimized away.
+    volatile float sink = 0.0f;
+
+    struct Result {
+        std::string name;
+        uint64_t items = 0;
+        double medianSeconds = 0.0;
+        double minSeconds = 0.0;
+    };
+
+    // once reports the seconds spent in the measured region so per-call setup
+    // stays out of the timing, and returns false if the operation failed.
+    struct Benchmark {
+        std::string name;
+        uint64_t items = 0;
+        std::function<bool(double&)> once;
+    };
+
+    // A sample calls once until kMinSampleSeconds of wall time have passed and
+    // records the mean time per call.
+    bool Sample(const Benchmark& benchmark, std::vector<double>& outSamples) {
+        double total = 0.0;
+        uint64_t calls = 0;
+        auto start = std::chrono::steady_clock::now();
+        do {
+            double callSeconds = 0.0;
+            if (!benchmark.once(callSeconds)) {
+                std::cerr << benchmark.name << ": failed" << std::endl;
+                return false;
+            }
+            total += callSeconds;
+            ++calls;
+        } while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < kMinSampleSeconds);
+        outSamples.push_back(total / calls);
+        return true;
+    }
+
+    // Samples every benchmark once per round rather than all repetitions of one
+    // benchmark back to back, so a slow phase of the machine is spread over all
+    // benchmarks instead of skewing a few of them.
+    bool RunAll(const std::vector<Benchmark>& benchmarks, size_t repetitions, std::vector<Result>& outResults) {
+        std::vector<std::vector<double>> samples(benchmarks.size());
+        for (size_t i = 0; i < repetitions; ++i) {
+            std::cerr << "Round " << i + 1 << "/" << repetitions << std::endl;
+            for (size_t b = 0; b < benchmarks.size(); ++b) {
+                if (!Sample(benchmarks[b], samples[b])) return false;
+            }
+        }
+
+        for (size_t b = 0; b < benchmarks.size(); ++b) {
+            std::vector<double>& seconds = samples[b];
+            std::sort(seconds.begin(), seconds.end());
+            Result result;
+            result.name = benchmarks[b].name;
+            result.items = benchmarks[b].items;
+            result.medianSeconds = seconds[seconds.size() / 2];
+            result.minSeconds = seconds.front();
+            std::cerr << result.name << ": " << result.medianSeconds * 1e3 << " ms median, "
+                      << static_cast<uint64_t>(result.items / std::max(result.medianSeconds, 1e-12)) << " items/sec" << std::endl;
+            outResults.push_back(result);
+        }
+        return true;
+    }
+
+    template <typename Fn>
+    double Time(Fn fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Deterministic cloud spread over a 100 m cube with intensities in [0, 255].
+    PointCloud MakeSyntheticCloud(size_t count) {
+        PointCloud cloud;
+        cloud.positions.resize(count);
+        cloud.scalarFields.push_back({"intensity", std::vector<float>(count)});
+        uint32_t state = 12345;
+        auto next = [&state]() {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float>(state >> 8) / static_cast<float>(1 << 24);
+        };
+        for (size_t i = 0; i < count; ++i) {
+            cloud.positions[i] = {next() * 100.0f - 50.0f, next() * 100.0f - 50.0f, next() * 100.0f - 50.0f};
+            cloud.scalarFields[0].values[i] = next() * 255.0f;
+        }
+        return cloud;
+    }
+
+    bool WriteCloud(const std::string& filename, const PointCloud& cloud) {
+        PlyWriter writer;
+        if (!writer.Open(filename, VertexLayout::XYZI, true)) return false;
+        PointCloud chunk;
+        for (size_t first = 0; first < cloud.Size(); first += kWriteChunkSize) {
+            size_t last = std::min(first + kWriteChunkSize, cloud.Size());
+            chunk.positions.assign(cloud.positions.begin() + first, cloud.positions.begin() + last);
+            chunk.scalarFields = {{"intensity", std::vector<float>(cloud.scalarFields[0].values.begin() + first,
+                                                                   cloud.scalarFields[0].values.begin() + last)}};
+            if (!writer.Write(chunk)) return false;
+        }
+        return writer.Close();
+    }
+
+    void AddLoad(const std::string& label, const std::string& filename, uint64_t points,
+                 std::vector<Benchmark>& benchmarks) {
+        benchmarks.push_back({"load/" + label, points, [filename](double& seconds) {
+            PointCloud cloud;
+            bool loaded = false;
+            seconds = Time([&] { loaded = PlyLoader::Load(filename, cloud); });
+            sink = sink + (cloud.Size() ? cloud.positions[0].x : 0.0f);
+            return loaded;
+        }});
+    }
+
+    // source must outlive the benchmarks.
+    void AddCloud(const std::string& label, const PointCloud& source, std::vector<Benchmark>& benchmarks) {
+        uint64_t points = source.Size();
+        Mat4 transform = Mat4::RotationX(0.3f) * Mat4::RotationY(0.2f) * Mat4::Translation(1.0f, 2.0f, 3.0f);
+        Aabb box = ComputeBounds(source.positions);
+        // Central half of the box on each axis
+        Aabb cropBox = {
+            box.minX * 0.75f + box.maxX * 0.25f, box.minY * 0.75f + box.maxY * 0.25f, box.minZ * 0.75f + box.maxZ * 0.25f,
+            box.minX * 0.25f + box.maxX * 0.75f, box.minY * 0.25f + box.maxY * 0.75f, box.minZ * 0.25f + box.maxZ * 0.75f,
+        };
+
+        benchmarks.push_back({"bounds/" + label, points, [&source](double& seconds) {
+            Aabb bounds;
+            seconds = Time([&] { bounds = ComputeBounds(source.positions); });
+            sink = sink + bounds.maxX;
+            return true;
+        }});
+
+        // In-place passes work on a fresh copy each call; the copy is not timed.
+        auto inPlace = [&](const std::string& name, std::function<void(PointCloud&)> op) {
+            benchmarks.push_back({name + "/" + label, points, [&source, op](double& seconds) {
+                PointCloud cloud = source;
+                seconds = Time([&] { op(cloud); });
+                sink = sink + static_cast<float>(cloud.Size());
+                return true;
+            }});
+        };
+        inPlace("normalize", [](PointCloud& cloud) { NormalizePositions(cloud.positions, 0.9f); });
+        inPlace("transform", [transform](PointCloud& cloud) { TransformPoints(transform, cloud); });
+        inPlace("crop", [cropBox](PointCloud& cloud) { CropPoints(cropBox, cloud); });
+        inPlace("subsample", [](PointCloud& cloud) {
+            uint64_t offset = 0;
+            SubsamplePoints(4, offset, cloud);
+        });
+    }
+
+    void AddMat4(std::vector<Benchmark>& benchmarks) {
+        benchmarks.push_back({"mat4/multiply", kMat4Iterations, [](double& seconds) {
+            Mat4 a = Mat4::RotationX(0.001f);
+            Mat4 acc = Mat4::Identity();
+            seconds = Time([&] {
+                for (uint64_t i = 0; i < kMat4Iterations; ++i) acc = acc * a;
+            });
+            sink = sink + acc.m[5];
+            return true;
+        }});
+
+        // The per-frame MVP composition done by Renderer::UpdateUniforms
+        benchmarks.push_back({"mat4/mvp", kMat4Iterations, [](double& seconds) {
+            float checksum = 0.0f;
+            seconds = Time([&] {
+                for (uint64_t i = 0; i < kMat4Iterations; ++i) {
+                    float angle = static_cast<float>(i) * 1e-6f;
+                    Mat4 projection = Mat4::Perspective(3.14159f / 4.0f, 4.0f / 3.0f, 0.1f, 100.0f);
+                    Mat4 view = Mat4::Translation(0.0f, 0.0f, -2.0f);
+                    Mat4 model = Mat4::RotationX(angle) * Mat4::RotationY(angle) *
+                                 Mat4::Translation(0.1f, 0.2f, 0.3f) * Mat4::Scale(1.5f);
+                    checksum += (projection * view * model).m[0];
+                }
+            });
+            sink = sink + checksum;
+            return true;
+        }});
+
+        benchmarks.push_back({"mat4/transpose", kMat4Iterations, [](double& seconds) {
+            Mat4 m = Mat4::RotationY(0.5f) * Mat4::Translation(1.0f, 2.0f, 3.0f);
+            seconds = Time([&] {
+                for (uint64_t i = 0; i < kMat4Iterations; ++i) m = m.Transpose();
+            });
+            sink = sink + m.m[3];
+            return true;
+        }});
+    }
+
+    // Number parsers for the command line and baseline; reject junk instead of throwing.
+    bool ParsePositive(const char* text, size_t& outValue) {
+        if (*text == '-') return false;
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(text, &end, 10);
+        if (end == text || *end != '\0' || value == 0) return false;
+        outValue = static_cast<size_t>(value);
+        return true;
+    }
+
+    // Accepts a finite number followed by the end of text or one of terminators.
+    bool ParseNumber(const char* text, double& outValue, const char* terminators = "") {
+        char* end = nullptr;
+        outValue = std::strtod(text, &end);
+        return end != text && (*end == '\0' || std::strchr(terminators, *end)) && std::isfinite(outValue);
+    }
+
+    void WriteJson(std::ostream& out, const std::vector<Result>& results) {
+        // One benchmark per line so baselines diff cleanly and ReadBaseline stays simple.
+        out << "{\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            char line[512];
+            std::snprintf(line, sizeof(line),
+                "    {\"name\": \"%s\", \"items\": %llu, \"median_ns\": %.0f, \"min_ns\": %.0f, \"items_per_sec\": %.0f}%s\n",
+                r.name.c_str(), static_cast<unsigned long long>(r.items), r.medianSeconds * 1e9, r.minSeconds * 1e9,
+                r.items / std::max(r.medianSeconds, 1e-12), i + 1 < results.size() ? "," : "");
+            out << line;
+        }
+        out << "  ]\n}\n";
+    }
+
+    // Reads name -> min_ns from a file written by WriteJson.
+    bool ReadBaseline(const std::string& filename, std::map<std::string, double>& outMinimums) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open baseline: " << filename << std::endl;
+            return false;
+        }
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t name = line.find("\"name\": \"");
+            size_t minimum = line.find("\"min_ns\": ");
+            if (name == std::string::npos || minimum == std::string::npos) continue;
+            name += 9;
+            std::string key = line.substr(name, line.find('"', name) - name);
+            if (!ParseNumber(line.c_str() + minimum + 10, outMinimums[key], ",}")) {
+                std::cerr << "Malformed baseline entry in " << filename << ": " << line << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Prints the change of every benchmark against the baseline; returns false
+    // if any fastest sample slowed down by more than threshold, or if a
+    // baseline benchmark did not run (e.g. --sizes differs from the baseline). The minimum is
+    // compared because noise only ever adds time.
+    bool Compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline, double threshold) {
+        bool ok = true;
+        for (const auto& r : results) {
+            auto it = baseline.find(r.name);
+            if (it == baseline.end()) {
+                std::cerr << r.name << ": not in baseline" << std::endl;
+                continue;
+            }
+            double change = r.minSeconds * 1e9 / it->second - 1.0;
+            bool regressed = change > threshold;
+            ok = ok && !regressed;
+            char line[256];
+            std::snprintf(line, sizeof(line), "%-32s %+7.1f%%%s", r.name.c_str(), change * 100.0, regressed ? "  REGRESSION" : "");
+            std::cerr << line << std::endl;
+        }
+        for (const auto& entry : baseline) {
+            bool ran = std::any_of(results.begin(), results.end(), [&](const Result& r) { return r.name == entry.first; });
+            if (!ran) {
+                std::cerr << entry.first << ": in baseline but not run; use the baseline's --sizes" << std::endl;
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    bool ParseSizes(const std::string& list, std::vector<size_t>& outSizes) {
+        outSizes.clear();
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            size_t size = 0;
+            if (!ParsePositive(item.c_str(), size)) return false;
+            outSizes.push_back(size);
+        }
+        return !outSizes.empty();
+    }
+
+    std::string SizeLabel(size_t count) {
+        if (count % 1000000 == 0) return std::to_string(count / 1000000) + "M";
+        if (count % 1000 == 0) return std::to_string(count / 1000) + "K";
+        return std::to_string(count);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string dataDir = "../data";
+    std::string outputFile;
+    std::string baselineFile;
+    std::vector<size_t> sizes = {1000000, 10000000};
+    size_t repetitions = kDefaultRepetitions;
+    double threshold = kDefaultThreshold;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--data" && i + 1 < argc) {
+            dataDir = argv[++i];
+        } else if (arg == "--sizes" && i + 1 < argc && ParseSizes(argv[i + 1], sizes)) {
+            ++i;
+        } else if (arg == "--repetitions" && i + 1 < argc && ParsePositive(argv[i + 1], repetitions)) {
+            ++i;
+        } else if (arg == "--out" && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if (arg == "--compare" && i + 1 < argc) {
+            baselineFile = argv[++i];
+        } else if (arg == "--threshold" && i + 1 < argc && ParseNumber(argv[i + 1], threshold) && threshold >= 0.0) {
+            ++i;
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [--data <dir>] [--sizes <n,n,...>] [--repetitions <n>]"
+                      << " [--out <file.json>] [--compare <baseline.json>] [--threshold <fraction>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!baselineFile.empty() && !ReadBaseline(baselineFile, baseline)) {
+        return 1;
+    }
+
+    // Every cloud and temporary file stays alive until all rounds are done.
+    std::vector<std::unique_ptr<PointCloud>> clouds;
+    std::vector<std::string> tempFiles;
+    std::vector<Benchmark> benchmarks;
+
+    for (const char* name : {"source", "target"}) {
+        std::string filename = dataDir + "/" + name + ".ply";
+        clouds.push_back(std::make_unique<PointCloud>());
+        if (!PlyLoader::Load(filename, *clouds.back())) {
+            return 1;
+        }
+        AddLoad(name, filename, clouds.back()->Size(), benchmarks);
+        AddCloud(name, *clouds.back(), benchmarks);
+    }
+
+    bool written = true;
+    for (size_t count : sizes) {
+        std::string label = SizeLabel(count);
+        clouds.push_back(std::make_unique<PointCloud>(MakeSyntheticCloud(count)));
+        std::string filename = (std::filesystem::temp_directory_path() / ("ply_bench_" + label + ".ply")).string();
+        tempFiles.push_back(filename);
+        if (!WriteCloud(filename, *clouds.back())) {
+            written = false;
+            break;
+        }
+        AddLoad(label, filename, count, benchmarks);
+        AddCloud(label, *clouds.back(), benchmarks);
+    }
+
+    AddMat4(benchmarks);
+
+    std::vector<Result> results;
+    bool ran = written && RunAll(benchmarks, repetitions, results);
+    for (const auto& filename : tempFiles) {
+        std::filesystem::remove(filename);
+    }
+    if (!ran) {
+        return 1;
+    }
+
+    if (outputFile.empty()) {
+        WriteJson(std::cout, results);
+    } else {
+        std::ofstream out(outputFile);
+        WriteJson(out, results);
+        if (!out) {
+            std::cerr << "Failed to write " << outputFile << std::endl;
+            return 1;
+        }
+    }
+
+    if (!baselineFile.empty() && !Compare(results, baseline, threshold)) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,201 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include "PlyLoader.h"
+#include "PlyWriter.h"
+#include "PointOps.h"
+#include "BoundedQueue.h"
+
+namespace {
+    // Chunks in flight per queue; with the chunk size this bounds peak memory.
+    constexpr size_t kQueueDepth = 2;
+    constexpr size_t kDefaultChunkSize = 1 << 20;
+
+    // Transforms one chunk in place
+    using Stage = std::function<void(PointCloud&)>;
+
+    // Reads a row-major 4x4 matrix such as data/T_target_source.txt.
+    bool LoadTransform(const std::string& filename, Mat4& outTransform) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open transform file: " << filename << std::endl;
+            return false;
+        }
+        for (int r = 0; r < 4; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                file >> outTransform.m[c * 4 + r];
+            }
+        }
+        if (!file) {
+            std::cerr << "Transform file must contain 16 numbers: " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool EndsWith(const std::string& s, const std::string& suffix) {
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // Number parsers for the command line; reject trailing junk instead of throwing.
+    bool ParseFloat(const char* text, float& outValue) {
+        char* end = nullptr;
+        outValue = std::strtof(text, &end);
+        return end != text && *end == '\0' && std::isfinite(outValue);
+    }
+
+    bool ParsePositive(const char* text, size_t& outValue) {
+        if (*text == '-') return false;
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(text, &end, 10);
+        if (end == text || *end != '\0' || value == 0 || value > std::numeric_limits<uint32_t>::max()) return false;
+        outValue = static_cast<size_t>(value);
+        return true;
+    }
+
+    void PrintUsage(const char* argv0) {
+        std::cerr << "Usage: " << argv0 << " <input.ply> <output> [stages...] [options]\n"
+                  << "Stages (applied in the order given):\n"
+                  << "  --transform <file>                    apply a row-major 4x4 transform\n"
+                  << "  --crop <minX minY minZ maxX maxY maxZ> keep points inside the box\n"
+                  << "  --subsample <N>                       keep every N-th point\n"
+                  << "Options:\n"
+                  << "  --layout <xyz|xyzi|xyzrgb>            output vertex layout (default xyzi)\n"
+                  << "  --format <ply|bin>                    output format (default from extension)\n"
+                  << "  --chunk <N>                           points per chunk (default " << kDefaultChunkSize << ")"
+                  << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    std::string inputFile = argv[1];
+    std::string outputFile = argv[2];
+    std::vector<Stage> stages;
+    VertexLayout layout = VertexLayout::XYZI;
+    bool writePlyHeader = !EndsWith(outputFile, ".bin");
+    size_t chunkSize = kDefaultChunkSize;
+
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        Aabb box;
+        size_t count = 0;
+        if (arg == "--transform" && i + 1 < argc) {
+            Mat4 transform;
+            if (!LoadTransform(argv[++i], transform)) return 1;
+            stages.push_back([transform](PointCloud& cloud) { TransformPoints(transform, cloud); });
+        } else if (arg == "--crop" && i + 6 < argc && ParseFloat(argv[i + 1], box.minX) && ParseFloat(argv[i + 2], box.minY) &&
+                   ParseFloat(argv[i + 3], box.minZ) && ParseFloat(argv[i + 4], box.maxX) &&
+                   ParseFloat(argv[i + 5], box.maxY) && ParseFloat(argv[i + 6], box.maxZ)) {
+            i += 6;
+            stages.push_back([box](PointCloud& cloud) { CropPoints(box, cloud); });
+        } else if (arg == "--subsample" && i + 1 < argc && ParsePositive(argv[i + 1], count)) {
+            ++i;
+            uint32_t stride = static_cast<uint32_t>(count);
+            // Each stage runs on a single thread, so the running offset needs no locking.
+            auto offset = std::make_shared<uint64_t>(0);
+            stages.push_back([stride, offset](PointCloud& cloud) { SubsamplePoints(stride, *offset, cloud); });
+        } else if (arg == "--layout" && i + 1 < argc) {
+            if (!ParseVertexLayout(argv[++i], layout)) {
+                std::cerr << "Unknown layout: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format != "ply" && format != "bin") {
+                std::cerr << "Unknown format: " << format << std::endl;
+                return 1;
+            }
+            writePlyHeader = (format == "ply");
+        } else if (arg == "--chunk" && i + 1 < argc && ParsePositive(argv[i + 1], chunkSize)) {
+            ++i;
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    PlyReader reader;
+    if (!reader.Open(inputFile)) {
+        return 1;
+    }
+    PlyWriter writer;
+    if (!writer.Open(outputFile, layout, writePlyHeader)) {
+        return 1;
+    }
+
+    // reader -> queues[0] -> stage 0 -> queues[1] -> ... -> queues[N] -> writer
+    std::vector<std::unique_ptr<BoundedQueue<PointCloud>>> queues;
+    for (size_t i = 0; i <= stages.size(); ++i) {
+        queues.push_back(std::make_unique<BoundedQueue<PointCloud>>(kQueueDepth));
+    }
+
+    std::atomic<bool> failed = false;
+    uint64_t pointsRead = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    threads.emplace_back([&] {
+        PointCloud chunk;
+        while (true) {
+            if (!reader.Read(chunk, chunkSize)) {
+                failed = true;
+                break;
+            }
+            if (chunk.Size() == 0) break;
+            pointsRead += chunk.Size();
+            queues[0]->Push(std::move(chunk));
+            chunk = {};
+        }
+        queues[0]->Close();
+    });
+
+    for (size_t s = 0; s < stages.size(); ++s) {
+        threads.emplace_back([&, s] {
+            PointCloud chunk;
+            while (queues[s]->Pop(chunk)) {
+                stages[s](chunk);
+                queues[s + 1]->Push(std::move(chunk));
+            }
+            queues[s + 1]->Close();
+        });
+    }
+
+    // Keep draining after a write error so upstream threads can finish.
+    PointCloud chunk;
+    while (queues.back()->Pop(chunk)) {
+        if (!failed && !writer.Write(chunk)) {
+            failed = true;
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (!writer.Close() || failed) {
+        std::cerr << "Failed to process " << inputFile << std::endl;
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Read " << pointsRead << " points, wrote " << writer.Count() << " points to " << outputFile << std::endl;
+    std::cout << "Elapsed " << seconds << " s, "
+              << static_cast<uint64_t>(pointsRead / std::max(seconds, 1e-9)) << " points/sec" << std::endl;
+    return 0;
+}